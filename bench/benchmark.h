@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+
+/*
+*	Minimal harness shared by the benchmarks.
+*	Every measurement becomes one row with the time per operation, printed as CSV or as a JSON array with --json.
+*	--quick uses smaller sizes and shorter runs so the benchmarks can double as smoke tests.
+*/
+
+namespace bench{
+	struct Result{
+		std::string name;
+		std::size_t size; //Number of elements, keys, etc. the operation worked on
+		std::size_t threads;
+		std::size_t iterations;
+		double nsPerOp;
+	};
+
+	struct Options{
+		bool json = false;
+		bool quick = false;
+	};
+
+	inline Options options;
+	inline std::vector<Result> results;
+	inline std::uint64_t sink = 0; //Keeps the compiler from removing the measured work
+
+	inline void parse_options(int argc, char** argv){
+		for(int i = 1; i < argc; ++i){
+			std::string_view arg = argv[i];
+
+			if(arg == "--json")
+				options.json = true;
+			else if(arg == "--quick")
+				options.quick = true;
+		}
+	}
+
+	//Makes value observable, so computing it can't be optimized away
+	template<typename T>
+	void keep(const T& value) noexcept{
+		std::uint64_t bits = 0;
+
+		std::memcpy(&bits, &value, std::min(sizeof(bits), sizeof(T)));
+		sink += bits;
+	}
+
+	//Runs func(iterations) with growing iteration counts until a run takes long enough and records the last run
+	template<typename Func>
+	void measure(const std::string& name, std::size_t size, std::size_t threads, std::size_t opsPerIteration, Func&& func){
+		using Clock = std::chrono::steady_clock;
+
+		double minTime = options.quick ? 1e7 : 2e8; //Nanoseconds
+		std::size_t iterations = 1;
+
+		for(;;){
+			auto start = Clock::now();
+
+			func(iterations);
+
+			double time = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+			if(time >= minTime || iterations >= (std::size_t{1} << 30)){
+				results.push_back(Result{name, size, threads, iterations, time / static_cast<double>(iterations * opsPerIteration)});
+
+				return;
+			}
+
+			iterations *= time > 0 ? std::clamp<std::size_t>(static_cast<std::size_t>(minTime / time * 1.2), 2, 100) : 100;
+		}
+	}
+
+	//Prints all results and returns the exit code for main
+	inline int report(){
+		if(options.json){
+			std::cout << "[\n";
+
+			for(std::size_t i = 0; i < results.size(); ++i){
+				const Result& result = results[i];
+
+				std::cout << "  {\"name\": \"" << result.name << "\", \"size\": " << result.size << ", \"threads\": " << result.threads
+						  << ", \"iterations\": " << result.iterations << ", \"ns_per_op\": " << result.nsPerOp << '}' << (i + 1 < results.size() ? ",\n" : "\n");
+			}
+
+			std::cout << "]\n";
+		}else{
+			std::cout << "name,size,threads,iterations,ns_per_op\n";
+
+			for(const Result& result : results)
+				std::cout << result.name << ',' << result.size << ',' << result.threads << ',' << result.iterations << ',' << result.nsPerOp << '\n';
+		}
+
+		return sink == 42 ? 1 : 0; //Practically never true, only makes sink observable
+	}
+}
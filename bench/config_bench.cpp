@@ -0,0 +1,169 @@
+/*
+*	Benchmarks for Config: loading, typed and string lookups, saving changes and reads from several threads.
+*	Output and options are described in benchmark.h, the size column is the number of keys in the file.
+*/
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include "config.h"
+#include "sharedConfig.h"
+#include "benchmark.h"
+
+namespace{
+	using bench::measure;
+	using bench::sink;
+
+	std::string key_name(std::size_t i){ return "key" + std::to_string(i); }
+	std::string section_name(std::size_t i){ return "section" + std::to_string(i / 100); } //100 keys per section
+
+	void write_file(const std::string& fileName, std::size_t keys){
+		std::ofstream out{fileName};
+
+		for(std::size_t i = 0; i < keys; ++i){
+			if(i % 100 == 0)
+				out << (i ? "\n" : "") << '[' << section_name(i) << "]\n";
+
+			out << key_name(i) << '=' << i << '\n';
+		}
+	}
+
+	void bench_load(const std::string& fileName, std::size_t keys){
+		write_file(fileName, keys);
+
+		measure("load_from_file", keys, 1, 1, [&](std::size_t iterations){
+			for(std::size_t i = 0; i < iterations; ++i){
+				util::Config config;
+
+				config.load_from_file(fileName, true);
+				sink += config.find(section_name(0), key_name(0)).valid();
+			}
+		});
+
+		measure("load_from_mapped_file", keys, 1, 1, [&](std::size_t iterations){
+			for(std::size_t i = 0; i < iterations; ++i){
+				util::Config config;
+
+				config.load_from_mapped_file(fileName, true);
+				sink += config.find(section_name(0), key_name(0)).valid();
+			}
+		});
+	}
+
+	void bench_lookups(const std::string& fileName, std::size_t keys){
+		util::Config loaded{fileName};
+		const util::Config& config = loaded; //Const lookups don't add missing keys
+		constexpr std::size_t lookupCount = 1024;
+		std::vector<std::pair<std::string, std::string>> hits, misses;
+
+		for(std::size_t i = 0; i < lookupCount; ++i){
+			std::size_t index = (i * 7919) % keys;
+
+			hits.emplace_back(section_name(index), key_name(index));
+			misses.emplace_back(section_name(index), "missing" + std::to_string(index));
+		}
+
+		auto lookup = [&](const char* name, const auto& keyList, auto get){
+			measure(name, keys, 1, keyList.size(), [&](std::size_t iterations){
+				for(std::size_t i = 0; i < iterations; ++i){
+					for(const auto& key : keyList)
+						sink += get(key.first, key.second);
+				}
+			});
+		};
+
+		lookup("get_int_hit", hits, [&](const std::string& section, const std::string& key){ return config.get<int>(section, key, 0); });
+		lookup("get_int_miss", misses, [&](const std::string& section, const std::string& key){ return config.get<int>(section, key, 0); });
+		lookup("get_string_hit", hits, [&](const std::string& section, const std::string& key){ return config.get(section, key, "").size(); });
+		lookup("get_string_miss", misses, [&](const std::string& section, const std::string& key){ return config.get(section, key, "").size(); });
+	}
+
+	//Changes changedKeys keys of a saved file and saves again, which merges the changes into the existing file
+	void bench_save(const std::string& fileName, std::size_t keys, std::size_t changedKeys, const char* name){
+		write_file(fileName, keys);
+
+		util::Config config{fileName};
+		std::size_t round = 0;
+
+		measure(name, keys, 1, 1, [&](std::size_t iterations){
+			for(std::size_t i = 0; i < iterations; ++i, ++round){
+				for(std::size_t k = 0; k < changedKeys; ++k){
+					std::size_t index = (k * keys) / changedKeys;
+
+					config.set(section_name(index), key_name(index), static_cast<int>(round));
+				}
+
+				sink += config.save_to_file(fileName);
+			}
+		});
+	}
+
+	void bench_threads(const std::string& fileName, std::size_t keys, std::size_t threadCount){
+		util::SharedConfig shared{util::Config{fileName}};
+		constexpr std::size_t lookupCount = 1024;
+		std::vector<std::pair<std::string, std::string>> hits;
+
+		for(std::size_t i = 0; i < lookupCount; ++i){
+			std::size_t index = (i * 7919) % keys;
+
+			hits.emplace_back(section_name(index), key_name(index));
+		}
+
+		//Every thread does the same number of iterations so the result is the time per read across all threads
+		measure("shared_get_int", keys, threadCount, lookupCount * threadCount, [&](std::size_t iterations){
+			std::vector<std::thread> threads;
+			std::vector<std::uint64_t> sums(threadCount);
+
+			for(std::size_t t = 0; t < threadCount; ++t){
+				threads.emplace_back([&, t]{
+					std::uint64_t sum = 0; //Stored once at the end, adding to sums[t] directly would share cache lines between threads
+
+					for(std::size_t i = 0; i < iterations; ++i){
+						util::SharedConfig::Snapshot snapshot = shared.snapshot();
+
+						for(const auto& key : hits)
+							sum += static_cast<std::uint64_t>(snapshot->get<int>(key.first, key.second, 0));
+					}
+
+					sums[t] = sum;
+				});
+			}
+
+			for(std::size_t t = 0; t < threadCount; ++t){
+				threads[t].join();
+				sink += sums[t];
+			}
+		});
+	}
+}
+
+int main(int argc, char** argv){
+	bench::parse_options(argc, argv);
+
+	bool quick = bench::options.quick;
+	std::string fileName = (std::filesystem::temp_directory_path() / ("config_bench" + std::to_string(std::random_device{}()) + ".ini")).string();
+	std::vector<std::size_t> sizes = quick ? std::vector<std::size_t>{1000, 10000} : std::vector<std::size_t>{1000, 100000, 1000000};
+	std::size_t saveSize = quick ? 10000 : 100000;
+	std::size_t maxThreads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 4);
+
+	for(std::size_t keys : sizes)
+		bench_load(fileName, keys);
+
+	for(std::size_t keys : sizes)
+		bench_lookups(fileName, keys);
+
+	bench_save(fileName, saveSize, 1, "save_small_diff");
+	bench_save(fileName, saveSize, saveSize / 10, "save_large_diff");
+
+	for(std::size_t threads = 1; threads <= maxThreads; threads *= 2)
+		bench_threads(fileName, saveSize, threads);
+
+	std::filesystem::remove(fileName);
+
+	return bench::report();
+}
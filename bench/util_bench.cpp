@@ -0,0 +1,619 @@
+/*
+*	Benchmarks for the smaller utilities, each measurement works on arrays of size elements.
+*	Output and options are described in benchmark.h.
+*/
+
+#include <cmath>
+#include <mutex>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include "logger.h"
+#include "random.h"
+#include "spatial.h"
+#include "fastMath.h"
+#include "mathUtil.h"
+#include "stringUtil.h"
+#include "benchmark.h"
+
+namespace{
+	using namespace util;
+	using bench::measure;
+	using bench::keep;
+
+	//Runs func on every element and adds up the results
+	template<typename T, typename Func>
+	void measure_each(const std::string& name, const std::vector<T>& values, Func func){
+		measure(name, values.size(), 1, values.size(), [&](std::size_t iterations){
+			float sum = 0.0f;
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(const T& value : values)
+					sum += static_cast<float>(func(value));
+			}
+
+			keep(sum);
+		});
+	}
+
+	//Runs a batched function over the whole input
+	template<typename Func>
+	void measure_batched(const std::string& name, std::size_t size, Func func){
+		measure(name, size, 1, size, [&](std::size_t iterations){
+			for(std::size_t n = 0; n < iterations; ++n)
+				func();
+		});
+	}
+
+	void bench_fast_math(std::size_t size){
+		std::vector<float> angles(size), positive(size), exponents(size), xs(size), out(size);
+
+		for(std::size_t i = 0; i < size; ++i){
+			float f = static_cast<float>(i) / static_cast<float>(size);
+
+			angles[i] = (f - 0.5f) * 200.0f;
+			positive[i] = 0.001f + f * 1000.0f;
+			exponents[i] = (f - 0.5f) * 100.0f;
+			xs[i] = std::cos(angles[i]);
+		}
+
+		measure_each("std_sin", angles, [](float x){ return std::sin(x); });
+		measure_each("fast_sin", angles, [](float x){ return math::fast::sin(x); });
+		measure_batched("fast_sin_batched", size, [&]{ math::fast::sin(angles.data(), out.data(), size); keep(out[0]); });
+		measure_each("std_exp", exponents, [](float x){ return std::exp(x); });
+		measure_each("fast_exp", exponents, [](float x){ return math::fast::exp(x); });
+		measure_batched("fast_exp_batched", size, [&]{ math::fast::exp(exponents.data(), out.data(), size); keep(out[0]); });
+		measure_each("std_rsqrt", positive, [](float x){ return 1.0f / std::sqrt(x); });
+		measure_each("fast_rsqrt", positive, [](float x){ return math::fast::rsqrt(x); });
+		measure_batched("fast_rsqrt_batched", size, [&]{ math::fast::rsqrt(positive.data(), out.data(), size); keep(out[0]); });
+		measure_batched("std_atan2", size, [&]{
+			for(std::size_t i = 0; i < size; ++i)
+				out[i] = std::atan2(angles[i], xs[i]);
+
+			keep(out[0]);
+		});
+		measure_batched("fast_atan2_batched", size, [&]{ math::fast::atan2(angles.data(), xs.data(), out.data(), size); keep(out[0]); });
+	}
+
+	//The per character std::tolower versions that were replaced, the casts only avoid undefined behavior for bytes above 127
+	int tolower_byte(char c){ return std::tolower(static_cast<unsigned char>(c)); }
+
+	std::string to_lower_tolower(std::string_view s){
+		std::string result;
+
+		result.reserve(s.size());
+
+		for(char c : s)
+			result += static_cast<char>(tolower_byte(c));
+
+		return result;
+	}
+
+	bool equals_ignore_case_tolower(std::string_view s1, std::string_view s2){
+		return std::equal(s1.begin(), s1.end(), s2.begin(), s2.end(), [](char a, char b){ return tolower_byte(a) == tolower_byte(b); });
+	}
+
+	bool less_ignore_case_tolower(std::string_view s1, std::string_view s2){
+		return std::lexicographical_compare(s1.begin(), s1.end(), s2.begin(), s2.end(), [](char a, char b){ return tolower_byte(a) < tolower_byte(b); });
+	}
+
+	//Short keys and long lines with UTF-8 text, both differ from their upper case versions only in the ASCII letters
+	void bench_case_folding(std::size_t size){
+		const std::string text = "Gr\xc3\xb6\xc3\x9f" "e Stra\xc3\x9f" "e, \xc3\x84rger \xc3\xbc" "ber \xc3\x9c" "bersetzung";
+
+		for(bool longInput : {false, true}){
+			std::vector<std::string> words(size), upperWords(size);
+
+			for(std::size_t i = 0; i < size; ++i){
+				words[i] = "Section" + std::to_string(i) + ".SomeMixedCaseKeyName";
+
+				if(longInput)
+					words[i] += " " + text + " " + text + " " + text + " " + words[i]; //Several 32 byte registers long
+
+				upperWords[i] = str::to_upper(words[i]);
+			}
+
+			std::string suffix = longInput ? "_long" : "";
+			std::size_t index = 0;
+
+			measure("to_lower_buffer" + suffix, size, 1, size, [&](std::size_t iterations){
+				char buffer[512];
+
+				for(std::size_t n = 0; n < iterations; ++n){
+					for(const std::string& word : words){
+						str::to_lower(word, buffer);
+						keep(buffer[0]);
+					}
+				}
+			});
+
+			measure_each("to_lower" + suffix, words, [](const std::string& word){ return str::to_lower(word).size(); });
+			measure_each("to_lower_tolower" + suffix, words, [](const std::string& word){ return to_lower_tolower(word).size(); });
+			measure_each("equals_ignore_case" + suffix, words, [&](const std::string& word){ return str::equals_ignore_case(word, upperWords[index++ % size]); });
+			measure_each("equals_ignore_case_tolower" + suffix, words, [&](const std::string& word){ return equals_ignore_case_tolower(word, upperWords[index++ % size]); });
+			measure_each("compare_ignore_case" + suffix, words, [&](const std::string& word){ return str::compare_ignore_case(word, upperWords[index++ % size]) < 0; });
+			measure_each("less_ignore_case_tolower" + suffix, words, [&](const std::string& word){ return less_ignore_case_tolower(word, upperWords[index++ % size]); });
+		}
+	}
+
+	//The std::stoi and std::stod calls to_value used to make are the baselines
+	void bench_number_parsing(std::size_t size){
+		std::vector<std::string> ints(size), doubles(size), shortestDoubles(size), bools(size);
+
+		for(std::size_t i = 0; i < size; ++i){
+			ints[i] = std::to_string(static_cast<int>(i * 7919) - 1000000);
+			doubles[i] = std::to_string(static_cast<double>(i) * 0.37);
+			shortestDoubles[i] = str::to_string(1.0 / static_cast<double>(i + 3)); //17 significant digits
+			bools[i] = i % 2 ? "true" : "0";
+		}
+
+		measure_each("std_stoi", ints, [](const std::string& s){ return std::stoi(s); });
+		measure_each("to_value_int", ints, [](const std::string& s){ return str::to_value<int>(s); });
+		measure_each("parse_value_int", ints, [](const std::string& s){ return str::parse_value<int>(s).value; });
+		measure_each("std_stod", doubles, [](const std::string& s){ return std::stod(s); });
+		measure_each("to_value_double", doubles, [](const std::string& s){ return str::to_value<double>(s); });
+		measure_each("parse_value_double", doubles, [](const std::string& s){ return str::parse_value<double>(s).value; });
+		measure_each("std_stod_17_digits", shortestDoubles, [](const std::string& s){ return std::stod(s); });
+		measure_each("parse_value_double_17_digits", shortestDoubles, [](const std::string& s){ return str::parse_value<double>(s).value; });
+		measure_each("parse_value_bool", bools, [](const std::string& s){ return str::parse_value<bool>(s).value; });
+	}
+
+	//The recursive std::string concatenation join_paths used to do
+	std::string join_paths_concatenate(std::string_view p1, std::string_view p2){
+		if(!str::is_path_separator(p1.back()) && !str::is_path_separator(p2.front()))
+			return std::string{p1} + "/" + std::string{p2};
+
+		return std::string{p1} + std::string{p2};
+	}
+
+	template<typename ... Args>
+	std::string join_paths_concatenate(std::string_view p1, std::string_view p2, const Args& ...paths){
+		return join_paths_concatenate(join_paths_concatenate(p1, p2), paths...);
+	}
+
+	//Short paths with a few components and deep ones with a dozen, joined from the same number of parts
+	void bench_paths(std::size_t size){
+		for(bool deep : {false, true}){
+			std::vector<std::string> words(size), paths(size);
+
+			for(std::size_t i = 0; i < size; ++i){
+				words[i] = "Section" + std::to_string(i) + ".SomeMixedCaseKeyName";
+
+				if(deep)
+					words[i] = "projects/" + words[i] + "/src/modules/core/detail/generated/" + std::to_string(i % 7) + "/include";
+
+				paths[i] = "/home/user/" + words[i] + "/file" + std::to_string(i) + ".txt";
+			}
+
+			std::string suffix = deep ? "_deep" : "";
+
+			measure_each("file_extension_view" + suffix, paths, [](const std::string& path){ return str::file_extension_view(path).size(); });
+			measure_each("filesystem_extension" + suffix, paths, [](const std::string& path){ return std::filesystem::path{path}.extension().native().size(); });
+			measure_each("join_paths" + suffix, words, [](const std::string& word){ return str::join_paths("/home/user", word, "assets", "file.txt").size(); });
+			measure_each("join_paths_concatenate" + suffix, words, [](const std::string& word){ return join_paths_concatenate("/home/user", word, "assets", "file.txt").size(); });
+			measure_each("filesystem_path_append" + suffix, words, [](const std::string& word){ return (std::filesystem::path{"/home/user"} / word / "assets" / "file.txt").native().size(); });
+			measure("append_paths_reused" + suffix, size, 1, size, [&](std::size_t iterations){
+				std::string buffer;
+
+				for(std::size_t n = 0; n < iterations; ++n){
+					for(const std::string& word : words){
+						buffer.clear();
+						str::append_paths(buffer, "/home/user", word, "assets", "file.txt");
+						keep(buffer.size());
+					}
+				}
+			});
+		}
+	}
+
+	//Scalar reference on plain column major arrays, m[column * 4 + row]
+	struct PlainMat4{
+		float m[16];
+	};
+
+	void plain_mul(const PlainMat4& a, const float* v, float* out){
+		for(int row = 0; row < 4; ++row)
+			out[row] = a.m[row] * v[0] + a.m[4 + row] * v[1] + a.m[8 + row] * v[2] + a.m[12 + row] * v[3];
+	}
+
+	PlainMat4 plain_mul(const PlainMat4& a, const PlainMat4& b){
+		PlainMat4 result;
+
+		for(int column = 0; column < 4; ++column){
+			for(int row = 0; row < 4; ++row){
+				float sum = 0.0f;
+
+				for(int k = 0; k < 4; ++k)
+					sum += a.m[k * 4 + row] * b.m[column * 4 + k];
+
+				result.m[column * 4 + row] = sum;
+			}
+		}
+
+		return result;
+	}
+
+	//Cofactor expansion, the usual scalar 4x4 inverse
+	PlainMat4 plain_inverse(const PlainMat4& a){
+		const float* m = a.m;
+		PlainMat4 result;
+		float* r = result.m;
+
+		r[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+		r[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+		r[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+		r[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+		r[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+		r[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+		r[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+		r[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+		r[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+		r[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+		r[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+		r[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+		r[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+		r[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+		r[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+		r[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+		float invDet = 1.0f / (m[0] * r[0] + m[1] * r[4] + m[2] * r[8] + m[3] * r[12]);
+
+		for(float& f : result.m)
+			f *= invDet;
+
+		return result;
+	}
+
+	void bench_matrices(std::size_t size){
+		std::vector<math::Mat4f> matrices(size);
+		std::vector<math::Vec4f> vectors(size);
+		std::vector<PlainMat4> plainMatrices(size);
+		std::vector<float> plainVectors(size * 4);
+
+		for(std::size_t i = 0; i < size; ++i){
+			float f = static_cast<float>(i % 100) * 0.01f;
+
+			matrices[i] = math::Mat4f::translation({f, 2.0f, 3.0f}) * math::Mat4f::scaling({1.0f + f, 2.0f, 0.5f});
+			vectors[i] = {f, 1.0f, 2.0f, 1.0f};
+
+			for(int column = 0; column < 4; ++column){
+				const math::Vec4f& c = matrices[i][column];
+
+				plainMatrices[i].m[column * 4] = c.x;
+				plainMatrices[i].m[column * 4 + 1] = c.y;
+				plainMatrices[i].m[column * 4 + 2] = c.z;
+				plainMatrices[i].m[column * 4 + 3] = c.w;
+			}
+
+			plainVectors[i * 4] = f;
+			plainVectors[i * 4 + 1] = 1.0f;
+			plainVectors[i * 4 + 2] = 2.0f;
+			plainVectors[i * 4 + 3] = 1.0f;
+		}
+
+		measure("plain_mat4_mul_vec4", size, 1, size, [&](std::size_t iterations){
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(std::size_t i = 0; i < size; ++i){
+					float out[4];
+
+					plain_mul(plainMatrices[i], &plainVectors[i * 4], out);
+					std::copy(out, out + 4, &plainVectors[i * 4]);
+				}
+			}
+
+			keep(plainVectors[0]);
+		});
+
+		measure("plain_mat4_mul_mat4", size, 1, size, [&](std::size_t iterations){
+			PlainMat4 product{{1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f}};
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(std::size_t i = 0; i < size; ++i)
+					product = plain_mul(plainMatrices[i], product);
+			}
+
+			keep(product.m[0]);
+		});
+
+		measure("plain_mat4_inverse", size, 1, size, [&](std::size_t iterations){
+			float sum = 0.0f;
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(std::size_t i = 0; i < size; ++i)
+					sum += plain_inverse(plainMatrices[i]).m[12];
+			}
+
+			keep(sum);
+		});
+
+		measure("mat4_mul_vec4", size, 1, size, [&](std::size_t iterations){
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(std::size_t i = 0; i < size; ++i)
+					vectors[i] = matrices[i] * vectors[i];
+			}
+
+			keep(vectors[0].x);
+		});
+
+		measure("mat4_mul_mat4", size, 1, size, [&](std::size_t iterations){
+			math::Mat4f product;
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(std::size_t i = 0; i < size; ++i)
+					product = matrices[i] * product;
+			}
+
+			keep(product[0].x);
+		});
+
+		measure("mat4_inverse", size, 1, size, [&](std::size_t iterations){
+			float sum = 0.0f;
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(std::size_t i = 0; i < size; ++i)
+					sum += matrices[i].inverse()[3].x;
+			}
+
+			keep(sum);
+		});
+
+		measure("mat4_transposed", size, 1, size, [&](std::size_t iterations){
+			float sum = 0.0f;
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(std::size_t i = 0; i < size; ++i)
+					sum += matrices[i].transposed()[0].w;
+			}
+
+			keep(sum);
+		});
+	}
+
+	//Boxes and points spread uniformly over a cube with an edge of 100, queries are about as large as a box
+	void bench_spatial(std::size_t size){
+		std::mt19937 rng{1};
+		std::uniform_real_distribution<float> position{0.0f, 100.0f}, radius{0.1f, 1.0f}, direction{-1.0f, 1.0f};
+		std::vector<math::Vec3f> centers(size), points(size);
+		std::vector<float> radii(size);
+		std::vector<math::AABB> boxes(size), queries(size);
+		std::vector<math::Ray> rays(size);
+		unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+		for(std::size_t i = 0; i < size; ++i){
+			math::Vec3f extent{radius(rng), radius(rng), radius(rng)};
+
+			centers[i] = {position(rng), position(rng), position(rng)};
+			radii[i] = radius(rng);
+			boxes[i] = {centers[i] - math::Vec3f{radii[i], radii[i], radii[i]}, centers[i] + math::Vec3f{radii[i], radii[i], radii[i]}};
+			points[i] = {position(rng), position(rng), position(rng)};
+			queries[i] = {points[i] - extent, points[i] + extent};
+			rays[i] = {centers[i], math::fast::normalize(math::Vec3f{direction(rng), direction(rng), direction(rng)})};
+		}
+
+		auto build = [&](unsigned threads){
+			measure("bvh_build", size, threads, size, [&](std::size_t iterations){
+				for(std::size_t n = 0; n < iterations; ++n){
+					math::Bvh bvh{boxes.data(), size, math::BvhOptions{4, threads}};
+
+					keep(bvh.nodes().size());
+				}
+			});
+		};
+
+		build(1);
+
+		if(maxThreads > 1)
+			build(maxThreads);
+
+		math::Bvh bvh{boxes.data(), size};
+
+		measure("bvh_query", size, 1, size, [&](std::size_t iterations){
+			std::size_t found = 0;
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(const math::AABB& query : queries)
+					bvh.query(query, [&](std::uint32_t){ ++found; });
+			}
+
+			keep(found);
+		});
+
+		//Spheres around the boxes, rays start at the centers so that they don't all miss
+		auto intersect = [&](std::uint32_t primitive, const math::Ray& ray, float){
+			math::Vec3f offset = ray.origin - centers[primitive];
+			float b = offset.dot(ray.direction);
+			float h = b * b - (offset.dot(offset) - radii[primitive] * radii[primitive]);
+			float t = h >= 0.0f ? -b - std::sqrt(h) : -1.0f;
+
+			return t >= 0.0f ? t : std::numeric_limits<float>::infinity();
+		};
+
+		//Unbounded rays must skip missed boxes just like bounded ones
+		for(float maxDistance : {1000.0f, std::numeric_limits<float>::infinity()}){
+			measure(std::isinf(maxDistance) ? "bvh_closest_hit_unbounded" : "bvh_closest_hit", size, 1, size, [&](std::size_t iterations){
+				float sum = 0.0f;
+
+				for(std::size_t n = 0; n < iterations; ++n){
+					for(const math::Ray& ray : rays)
+						sum += static_cast<float>(bvh.closest_hit(ray, maxDistance, intersect).hit());
+				}
+
+				keep(sum);
+			});
+		}
+
+		measure("grid_build", size, 1, size, [&](std::size_t iterations){
+			for(std::size_t n = 0; n < iterations; ++n){
+				math::PointGrid grid{points.data(), size, 2.0f};
+
+				keep(grid.size());
+			}
+		});
+
+		math::PointGrid grid{points.data(), size, 2.0f};
+
+		measure("grid_radius_query", size, 1, size, [&](std::size_t iterations){
+			std::size_t found = 0;
+
+			for(std::size_t n = 0; n < iterations; ++n){
+				for(const math::Vec3f& center : centers)
+					grid.for_each_in_radius(center, 2.0f, [&](std::uint32_t){ ++found; });
+			}
+
+			keep(found);
+		});
+	}
+
+	//Runs func(thread, i) count times on every thread, the result is the time per call across all threads
+	template<typename Func>
+	void measure_threads(const char* name, std::size_t count, std::size_t threadCount, Func func){
+		measure(name, count, threadCount, count * threadCount, [&](std::size_t iterations){
+			std::vector<std::thread> threads;
+
+			for(std::size_t t = 0; t < threadCount; ++t){
+				threads.emplace_back([&, t]{
+					for(std::size_t n = 0; n < iterations; ++n){
+						for(std::size_t i = 0; i < count; ++i)
+							func(t, i);
+					}
+				});
+			}
+
+			for(auto& thread : threads)
+				thread.join();
+		});
+	}
+
+	//Cost on the logging threads, the Logger formats and writes on its own thread while the baselines do it in place
+	void bench_logger(std::size_t count){
+		std::string fileName = (std::filesystem::temp_directory_path() / ("util_bench" + std::to_string(std::random_device{}()) + ".log")).string();
+		std::size_t maxThreads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 4);
+		const std::string path = "/home/user/file.txt";
+
+		for(std::size_t threads = 1; threads <= maxThreads; threads *= 2){
+			for(LogOverflow overflow : {LogOverflow::Drop, LogOverflow::Block}){
+				Logger logger{fileName, overflow};
+
+				measure_threads(overflow == LogOverflow::Drop ? "logger_drop" : "logger_block", count, threads, [&](std::size_t thread, std::size_t i){
+					logger.info("Thread {1} loaded {2} entries from {3} in {4} ms", thread, i, path, 1.5);
+				});
+			}
+
+			std::FILE* file = std::fopen(fileName.c_str(), "ab");
+
+			measure_threads("fprintf", count, threads, [&](std::size_t thread, std::size_t i){
+				std::fprintf(file, "Thread %zu loaded %zu entries from %s in %g ms\n", thread, i, path.c_str(), 1.5);
+			});
+			std::fclose(file);
+
+			std::ofstream stream{fileName, std::ios::app};
+			std::mutex streamMutex;
+
+			measure_threads("locked_ofstream", count, threads, [&](std::size_t thread, std::size_t i){
+				std::lock_guard<std::mutex> lock{streamMutex};
+
+				stream << "Thread " << thread << " loaded " << i << " entries from " << path << " in " << 1.5 << " ms\n";
+			});
+		}
+
+		std::filesystem::remove(fileName);
+	}
+
+	//Calls gen() size times and adds up the results
+	template<typename Generator>
+	void measure_generator(const char* name, std::size_t size, Generator gen){
+		measure(name, size, 1, size, [&](std::size_t iterations){
+			std::uint64_t sum = 0;
+
+			for(std::size_t n = 0; n < iterations * size; ++n)
+				sum += gen();
+
+			keep(sum);
+		});
+	}
+
+	//The rand_range that was replaced, kept as the baseline
+	float rand_range_std_rand(float min, float max) noexcept{
+		return math::lerp(min, max, std::rand() / static_cast<float>(RAND_MAX));
+	}
+
+	void bench_random(std::size_t size){
+		math::Xoshiro256 xoshiro{1};
+		math::Pcg32 pcg{1};
+		std::mt19937 mt{1};
+		std::mt19937_64 mt64{1};
+
+		measure_generator("std_rand", size, []{ return std::rand(); });
+		measure_generator("mt19937", size, [&]{ return mt(); });
+		measure_generator("mt19937_64", size, [&]{ return mt64(); });
+		measure_generator("xoshiro256", size, [&]{ return xoshiro(); });
+		measure_generator("pcg32", size, [&]{ return pcg(); });
+
+		//Whole arrays, compared with a loop over the scalar generator
+		math::Xoshiro256x4 bulk{1};
+		std::vector<std::uint32_t> words(size);
+		std::vector<float> floats(size);
+		std::vector<std::int32_t> ints(size);
+
+		measure_batched("xoshiro256_loop_fill_float", size, [&]{
+			for(float& f : floats)
+				f = math::uniform_float(xoshiro, -1.0f, 1.0f);
+
+			keep(floats[0]);
+		});
+		measure_batched("xoshiro256x4_fill_bits", size, [&]{ bulk.fill(words.data(), size); keep(words[0]); });
+		measure_batched("xoshiro256x4_fill_float", size, [&]{ bulk.fill(floats.data(), size, -1.0f, 1.0f); keep(floats[0]); });
+		measure_batched("xoshiro256x4_fill_int", size, [&]{ bulk.fill(ints.data(), size, -100, 100); keep(ints[0]); });
+
+		//Numbers in a range
+		std::uniform_int_distribution<int> distribution{0, 99};
+		std::uniform_real_distribution<float> realDistribution{-1.0f, 1.0f};
+
+		measure_generator("std_rand_modulo", size, []{ return std::rand() % 100; });
+		measure_generator("uniform_int_distribution", size, [&]{ return distribution(mt); });
+		measure_generator("uniform_int", size, [&]{ return math::uniform_int(xoshiro, 0, 99); });
+		measure_generator("uniform_real_distribution", size, [&]{ return static_cast<std::uint64_t>(realDistribution(mt) * 1000.0f); });
+		measure_generator("rand_range_std_rand", size, []{ return static_cast<std::uint64_t>(rand_range_std_rand(0.0f, 1000.0f)); });
+		measure_generator("rand_range", size, []{ return static_cast<std::uint64_t>(math::rand_range(0.0f, 1000.0f)); });
+
+		//Threads sharing the state of std::rand compared with one generator per thread
+		std::size_t maxThreads = std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 4);
+		struct alignas(64) Sum{ float value = 0.0f; }; //One cache line per thread
+		std::vector<Sum> sums(maxThreads);
+
+		for(std::size_t threads = 1; threads <= maxThreads; threads *= 2){
+			measure_threads("rand_range_std_rand", size, threads, [&](std::size_t thread, std::size_t){ sums[thread].value += rand_range_std_rand(0.0f, 1.0f); });
+			measure_threads("rand_range", size, threads, [&](std::size_t thread, std::size_t){ sums[thread].value += math::rand_range(0.0f, 1.0f); });
+		}
+
+		keep(sums[0].value);
+	}
+}
+
+int main(int argc, char** argv){
+	bench::parse_options(argc, argv);
+
+	std::size_t size = bench::options.quick ? 256 : 4096;
+
+	bench_matrices(size);
+	bench_fast_math(size);
+	bench_case_folding(size);
+	bench_number_parsing(size);
+	bench_paths(size);
+	bench_spatial(size * 16); //Small trees fit in the cache and would hide the cost of building
+	bench_logger(size);
+	bench_random(size);
+
+	return bench::report();
+}
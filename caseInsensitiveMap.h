@@ -0,0 +1,222 @@
+#pragma once
+
+#include <tuple>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+#include <string_view>
+#include "stringUtil.h"
+
+namespace util{
+	/*
+	*	Hash map from case insensitive string keys to values.
+	*	Entries are stored contiguously in insertion order, erasing moves the last entry into the gap.
+	*	Lookups take a string_view so nothing has to be allocated to find a key.
+	*	Keys must not be changed through iterators. Inserting or erasing invalidates iterators and references.
+	*/
+	template<typename T>
+	class CaseInsensitiveMap{
+	public:
+		using value_type = std::pair<std::string, T>;
+		using iterator = typename std::vector<value_type>::iterator;
+		using const_iterator = typename std::vector<value_type>::const_iterator;
+
+		CaseInsensitiveMap() = default;
+
+		CaseInsensitiveMap(std::initializer_list<std::pair<std::string_view, T>> values){
+			reserve(values.size());
+
+			for(const auto& value : values)
+				insert_or_assign(value.first, value.second);
+		}
+
+		std::size_t size() const noexcept{ return entries.size(); }
+		bool empty() const noexcept{ return entries.empty(); }
+
+		iterator begin() noexcept{ return entries.begin(); }
+		iterator end() noexcept{ return entries.end(); }
+		const_iterator begin() const noexcept{ return entries.begin(); }
+		const_iterator end() const noexcept{ return entries.end(); }
+
+		void clear() noexcept{
+			entries.clear();
+			index.clear();
+		}
+
+		//Makes sure count entries fit without growing the index
+		void reserve(std::size_t count){
+			entries.reserve(count);
+
+			if(count * 2 > index.size())
+				rehash(count * 2);
+		}
+
+		iterator find(std::string_view key) noexcept{
+			std::size_t entry = find_entry(key, str::hash_ignore_case(key));
+
+			return entry != npos ? entries.begin() + static_cast<std::ptrdiff_t>(entry) : entries.end();
+		}
+
+		const_iterator find(std::string_view key) const noexcept{
+			std::size_t entry = find_entry(key, str::hash_ignore_case(key));
+
+			return entry != npos ? entries.begin() + static_cast<std::ptrdiff_t>(entry) : entries.end();
+		}
+
+		bool contains(std::string_view key) const noexcept{
+			return find(key) != end();
+		}
+
+		T& at(std::string_view key){
+			auto it = find(key);
+
+			if(it == end())
+				throw std::out_of_range{"CaseInsensitiveMap::at: Key not found"};
+
+			return it->second;
+		}
+
+		const T& at(std::string_view key) const{
+			auto it = find(key);
+
+			if(it == end())
+				throw std::out_of_range{"CaseInsensitiveMap::at: Key not found"};
+
+			return it->second;
+		}
+
+		T& operator[](std::string_view key){
+			return try_emplace(key).first->second;
+		}
+
+		//Constructs the value from args unless the key already exists, the key keeps the spelling it was first inserted with
+		template<typename ... Args>
+		std::pair<iterator, bool> try_emplace(std::string_view key, Args&& ...args){
+			std::uint64_t hash = str::hash_ignore_case(key);
+			std::size_t entry = find_entry(key, hash);
+
+			if(entry != npos)
+				return {entries.begin() + static_cast<std::ptrdiff_t>(entry), false};
+
+			if((entries.size() + 1) * 2 > index.size())
+				rehash(std::max<std::size_t>(16, index.size() * 2));
+
+			entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+			insert_slot(hash, entries.size() - 1);
+
+			return {entries.end() - 1, true};
+		}
+
+		template<typename V>
+		std::pair<iterator, bool> insert_or_assign(std::string_view key, V&& value){
+			auto result = try_emplace(key, std::forward<V>(value));
+
+			if(!result.second)
+				result.first->second = std::forward<V>(value);
+
+			return result;
+		}
+
+		bool erase(std::string_view key){
+			if(index.empty())
+				return false;
+
+			std::size_t mask = index.size() - 1;
+			std::size_t slot = find_slot(key, str::hash_ignore_case(key));
+
+			if(slot == npos)
+				return false;
+
+			std::size_t entry = index[slot].entry;
+
+			//Backward shift deletion so that no tombstones are needed
+			for(std::size_t next = (slot + 1) & mask; index[next].entry != npos; next = (next + 1) & mask){
+				std::size_t home = static_cast<std::size_t>(index[next].hash) & mask;
+
+				if(((next - home) & mask) >= ((next - slot) & mask)){
+					index[slot] = index[next];
+					slot = next;
+				}
+			}
+
+			index[slot] = IndexSlot{};
+
+			std::size_t last = entries.size() - 1;
+
+			if(entry != last){
+				std::size_t moved = static_cast<std::size_t>(str::hash_ignore_case(entries[last].first)) & mask;
+
+				while(index[moved].entry != last)
+					moved = (moved + 1) & mask;
+
+				index[moved].entry = entry;
+				entries[entry] = std::move(entries[last]);
+			}
+
+			entries.pop_back();
+
+			return true;
+		}
+
+	private:
+		static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+		struct IndexSlot{
+			std::uint64_t hash = 0;
+			std::size_t entry = npos;
+		};
+
+		std::vector<value_type> entries;
+		std::vector<IndexSlot> index; //Open addressing table over entries, size is always zero or a power of two
+
+		std::size_t find_slot(std::string_view key, std::uint64_t hash) const noexcept{
+			if(index.empty())
+				return npos;
+
+			std::size_t mask = index.size() - 1;
+
+			for(std::size_t i = static_cast<std::size_t>(hash) & mask; index[i].entry != npos; i = (i + 1) & mask){
+				if(index[i].hash == hash && str::equals_ignore_case(entries[index[i].entry].first, key))
+					return i;
+			}
+
+			return npos;
+		}
+
+		std::size_t find_entry(std::string_view key, std::uint64_t hash) const noexcept{
+			std::size_t slot = find_slot(key, hash);
+
+			return slot != npos ? index[slot].entry : npos;
+		}
+
+		void insert_slot(std::uint64_t hash, std::size_t entry) noexcept{
+			std::size_t mask = index.size() - 1;
+			std::size_t i = static_cast<std::size_t>(hash) & mask;
+
+			while(index[i].entry != npos)
+				i = (i + 1) & mask;
+
+			index[i] = IndexSlot{hash, entry};
+		}
+
+		void rehash(std::size_t minSize){
+			std::size_t size = 16;
+
+			while(size < minSize)
+				size *= 2;
+
+			std::vector<IndexSlot> oldIndex(size);
+
+			oldIndex.swap(index);
+
+			for(const IndexSlot& slot : oldIndex){
+				if(slot.entry != npos)
+					insert_slot(slot.hash, slot.entry);
+			}
+		}
+	};
+}
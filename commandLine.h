@@ -1,34 +1,165 @@
 #pragma once
 
-#include <vector>
+#include <array>
+#include <tuple>
+#include <cctype>
+#include <memory>
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
 #include <string_view>
-#include <unordered_map>
+#include <type_traits>
 #include "stringUtil.h"
 
 namespace util{
+	enum class OptionError{
+		None,
+		Missing, //Option wasn't passed or has no value
+		Invalid, //Value couldn't be converted to the requested type
+		OutOfRange //Value doesn't fit into the requested type
+	};
+
+	//Result of a typed option lookup that carries an error instead of throwing
+	template<typename T>
+	struct OptionValue{
+		T value{};
+		OptionError error = OptionError::None;
+
+		explicit operator bool() const noexcept{ return error == OptionError::None; }
+		T value_or(T defaultValue) const{ return error == OptionError::None ? value : defaultValue; }
+	};
+
+	/*
+	*	Arguments are kept as views into argv which is expected to outlive the object.
+	*	When constructed from a single string, that string is copied once and all views refer to the copy.
+	*	Options are stored without their leading dashes and looked up with or without them,
+	*	so has_option("foo"), has_option("-foo") and has_option("--foo") all find both -foo and --foo.
+	*/
 	class CommandLine{
 	public:
 		CommandLine() = default;
-		CommandLine(int argc, const char* const* const argv){ init({argv, argv + argc}); }
-		CommandLine(std::string_view cmd){ init(str::split(cmd)); }
+		CommandLine(int argc, const char* const* const argv){ init(argc, argv); }
+
+		CommandLine(std::string_view cmd) : storage{std::make_shared<const std::string>(cmd)}{
+			for(std::string_view arg : str::split_range(*storage))
+				argvec.push_back(arg);
+
+			init();
+		}
+
+		bool has_option(std::string_view arg) const{ return find_option(arg) != optionValues.rend(); }
+		const std::vector<std::string_view>& argv() const{ return argvec; }
+		const std::vector<std::string_view>& values_without_option() const{ return values; }
+
+		//Returns the value of the last occurrence of an option
+		std::string_view value_for_option(std::string_view option) const{
+			auto it = find_option(option);
+
+			return it != optionValues.rend() ? it->second : std::string_view{};
+		}
+
+		//Returns the values of all occurrences of an option in order
+		std::vector<std::string_view> values_for_option(std::string_view option) const{
+			std::vector<std::string_view> result;
+
+			option = option_name(option);
+
+			for(const auto& optionValue : optionValues){
+				if(optionValue.first == option)
+					result.push_back(optionValue.second);
+			}
+
+			return result;
+		}
+
+		/*
+		*	Typed value of the last occurrence of an option, supports everything str::from_string does.
+		*	Options of type bool that were passed without a value count as true.
+		*/
+		template<typename T>
+		OptionValue<T> value_for_option(std::string_view option) const{
+			auto it = find_option(option);
+
+			if(it == optionValues.rend())
+				return {T{}, OptionError::Missing};
+
+			if constexpr(std::is_same_v<T, bool>){
+				if(it->second.empty())
+					return {true, OptionError::None};
+			}
+
+			return convert<T>(it->second);
+		}
+
+		//Values of all occurrences of an option, each of which may also contain a list separated by separator
+		template<typename T>
+		OptionValue<std::vector<T>> list_for_option(std::string_view option, char separator = ',') const{
+			OptionValue<std::vector<T>> result{{}, OptionError::Missing};
 
-		bool has_option(const std::string& arg) const{ return optionValues.find(arg) != optionValues.end(); }
-		const std::vector<std::string>& argv() const{ return argvec; }
-		const std::vector<std::string>& values_without_option() const{ return values; }
+			option = option_name(option);
 
-		std::string value_for_option(const std::string& option) const{
-			if(has_option(option))
-				return optionValues.find(option)->second;
+			for(const auto& optionValue : optionValues){
+				if(optionValue.first != option)
+					continue;
 
-			return "";
+				std::string_view list = optionValue.second;
+
+				result.error = OptionError::None;
+
+				while(!list.empty()){
+					std::size_t end = std::min(list.find(separator), list.size());
+					OptionValue<T> element = convert<T>(list.substr(0, end));
+
+					if(!element)
+						return {{}, element.error};
+
+					result.value.push_back(std::move(element.value));
+					list.remove_prefix(std::min(end + 1, list.size()));
+				}
+			}
+
+			return result;
+		}
+
+		//Named enum values, e.g. enum_for_option<Mode>("mode", {{"fast", Mode::Fast}, {"safe", Mode::Safe}}), names are case insensitive
+		template<typename Enum, std::size_t N>
+		OptionValue<Enum> enum_for_option(std::string_view option, const std::pair<std::string_view, Enum> (&names)[N]) const{
+			auto it = find_option(option);
+
+			if(it == optionValues.rend())
+				return {Enum{}, OptionError::Missing};
+
+			for(const auto& name : names){
+				if(str::CaseInsensitiveEqual{}(name.first, it->second))
+					return {name.second, OptionError::None};
+			}
+
+			return {Enum{}, OptionError::Invalid};
+		}
+
+		//Number of bytes with an optional unit as understood by str::parse_byte_size, e.g. 64K or 2GiB
+		OptionValue<std::uint64_t> size_for_option(std::string_view option) const{
+			auto it = find_option(option);
+
+			if(it == optionValues.rend())
+				return {0, OptionError::Missing};
+
+			OptionValue<std::uint64_t> result;
+
+			result.error = to_option_error(str::parse_byte_size(it->second, result.value), it->second);
+
+			return result;
 		}
 
 		std::string str() const{
 			std::string result;
 
-			for(const std::string& s : argvec)
-				result += s + " ";
+			for(std::string_view s : argvec){
+				result += s;
+				result += ' ';
+			}
 
 			if(!result.empty())
 				result.pop_back(); //Removing trailing whitespace
@@ -37,27 +168,214 @@ namespace util{
 		}
 
 	private:
-		std::vector<std::string> argvec;
-		std::vector<std::string> values; //Values that don't belong to an option
-		std::unordered_map<std::string, std::string> optionValues; //Options with their respective parameter values
+		std::shared_ptr<const std::string> storage; //Only used when constructed from a single string, shared between copies
+		std::vector<std::string_view> argvec;
+		std::vector<std::string_view> values; //Values that don't belong to an option
+		std::vector<std::pair<std::string_view, std::string_view>> optionValues; //Every occurrence of an option with its value, there are usually too few to make hashing worth it
+
+		void init(int argc, const char* const* const argv){
+			argvec.reserve(static_cast<std::size_t>(argc));
 
-		void init(const std::vector<std::string>& argv){
-			const char* currentOption = nullptr;
+			for(int i = 0; i < argc; ++i)
+				argvec.emplace_back(argv[i]);
+
+			init();
+		}
 
-			for(const std::string& s : argv){
-				argvec.push_back(s);
+		/*
+		*	Options start with - or -- and take the following argument as their value unless it is an option itself.
+		*	The value can also be attached with =, e.g. --name=value.
+		*	Negative numbers like -1 or -.5 are always values, either of the preceding option or on their own.
+		*/
+		void init(){
+			std::size_t currentOption = optionValues.size(); //Option still waiting for its value
 
-				if(s.size() > 1 && s[0] == '-'){
-					currentOption = s.c_str() + 1;
+			for(std::string_view s : argvec){
+				if(is_option(s)){
+					std::string_view option = option_name(s);
+					std::size_t equals = option.find('=');
 
-					optionValues.insert(std::pair<std::string, std::string>{currentOption, ""});
-				}else if(currentOption){
-					optionValues[currentOption] = s;
-					currentOption = nullptr;
+					if(equals != std::string_view::npos){
+						optionValues.emplace_back(option.substr(0, equals), option.substr(equals + 1));
+						currentOption = optionValues.size();
+					}else{
+						optionValues.emplace_back(option, std::string_view{});
+						currentOption = optionValues.size() - 1;
+					}
+				}else if(currentOption < optionValues.size()){
+					optionValues[currentOption].second = s;
+					currentOption = optionValues.size();
 				}else{
 					values.push_back(s);
 				}
 			}
 		}
+
+		//Searches backwards so the last occurrence wins
+		std::vector<std::pair<std::string_view, std::string_view>>::const_reverse_iterator find_option(std::string_view option) const{
+			option = option_name(option);
+
+			return std::find_if(optionValues.rbegin(), optionValues.rend(), [option](const auto& optionValue){ return optionValue.first == option; });
+		}
+
+		template<typename ... Ts>
+		friend class OptionSchema;
+
+		static bool is_option(std::string_view s) noexcept{
+			bool negativeNumber = s.size() > 1 && s[0] == '-' && (std::isdigit(static_cast<unsigned char>(s[1])) || s[1] == '.');
+
+			return s.size() > 1 && s[0] == '-' && !negativeNumber;
+		}
+
+		//Removes up to two leading dashes
+		static std::string_view option_name(std::string_view s) noexcept{
+			for(int i = 0; i < 2 && s.size() > 1 && s[0] == '-'; ++i)
+				s.remove_prefix(1);
+
+			return s;
+		}
+
+		static OptionError to_option_error(std::errc error, std::string_view value) noexcept{
+			if(error == std::errc{})
+				return OptionError::None;
+
+			if(value.empty())
+				return OptionError::Missing;
+
+			return error == std::errc::result_out_of_range ? OptionError::OutOfRange : OptionError::Invalid;
+		}
+
+		template<typename T>
+		static OptionValue<T> convert(std::string_view s){
+			OptionValue<T> result;
+
+			result.error = to_option_error(str::from_string(s, result.value), s);
+
+			return result;
+		}
+	};
+
+	//Single entry of an OptionSchema, options of type bool are flags that don't need a value
+	template<typename T>
+	struct Option{
+		std::string_view name;
+		T defaultValue{};
+	};
+
+	template<typename T>
+	Option(std::string_view, T) -> Option<T>;
+	Option(std::string_view, const char*) -> Option<std::string_view>;
+
+	/*
+	*	Command line options known at compile time.
+	*	Option indices can be looked up in constant expressions so that reading a parsed option is a plain tuple access,
+	*	and parsing doesn't allocate unless an option's type does (e.g. std::string):
+	*
+	*		constexpr util::OptionSchema schema{util::Option{"threads", 4}, util::Option{"verbose", false}, util::Option{"out", "a.txt"}};
+	*
+	*		auto options = schema.parse(argc, argv);
+	*		int threads = options.get<schema.index_of("threads")>();
+	*
+	*	Options may be passed as -name value, --name value or --name=value and support all types str::from_string does.
+	*	Values are converted once while parsing.
+	*/
+	template<typename ... Ts>
+	class OptionSchema{
+	public:
+		static constexpr std::size_t npos = sizeof...(Ts);
+
+		class Values{
+		public:
+			template<std::size_t Index>
+			const auto& get() const noexcept{ return std::get<Index>(values); }
+
+			template<std::size_t Index>
+			bool has() const noexcept{ return given[Index]; }
+
+			//Whether all given values could be converted to the type of their option
+			bool valid() const noexcept{ return invalidOption.empty(); }
+			//Name of the first option whose value couldn't be converted
+			std::string_view invalid_option() const noexcept{ return invalidOption; }
+
+		private:
+			friend class OptionSchema;
+
+			std::tuple<Ts...> values;
+			std::array<bool, sizeof...(Ts)> given{};
+			std::string_view invalidOption;
+		};
+
+		constexpr OptionSchema(Option<Ts> ... options) : names{options.name...}, defaults{options.defaultValue...}{}
+
+		//Returns the index of an option or npos if there is none with that name
+		constexpr std::size_t index_of(std::string_view name) const noexcept{
+			for(std::size_t i = 0; i < names.size(); ++i){
+				if(names[i] == name)
+					return i;
+			}
+
+			return npos;
+		}
+
+		constexpr std::string_view name_of(std::size_t index) const noexcept{ return names[index]; }
+
+		//Arguments that don't belong to an option are ignored, use CommandLine if those are needed as well
+		Values parse(int argc, const char* const* const argv) const{
+			Values result;
+			std::size_t pending = npos; //Option still waiting for its value
+
+			result.values = defaults;
+
+			for(int i = 0; i < argc; ++i){
+				std::string_view arg = argv[i];
+
+				if(CommandLine::is_option(arg)){
+					arg = CommandLine::option_name(arg);
+
+					std::size_t equals = arg.find('=');
+					std::size_t index = index_of(arg.substr(0, equals));
+
+					pending = npos;
+
+					if(index == npos)
+						continue;
+
+					result.given[index] = true;
+
+					if(equals != std::string_view::npos)
+						assign(result, index, arg.substr(equals + 1));
+					else if(is_flag(index))
+						assign(result, index, "true");
+					else
+						pending = index;
+				}else if(pending != npos){
+					assign(result, pending, arg);
+					pending = npos;
+				}
+			}
+
+			return result;
+		}
+
+	private:
+		std::array<std::string_view, sizeof...(Ts)> names;
+		std::tuple<Ts...> defaults;
+
+		static constexpr bool is_flag(std::size_t index) noexcept{
+			constexpr bool flags[] = {false, std::is_same_v<Ts, bool>...}; //Leading element so the array is never empty
+
+			return flags[index + 1];
+		}
+
+		template<std::size_t Index = 0>
+		void assign(Values& result, std::size_t index, std::string_view value) const{
+			if constexpr(Index < sizeof...(Ts)){
+				if(Index != index)
+					return assign<Index + 1>(result, index, value);
+
+				if(str::from_string(value, std::get<Index>(result.values)) != std::errc{} && result.invalidOption.empty())
+					result.invalidOption = names[Index];
+			}
+		}
 	};
-}
\ No newline at end of file
+}
@@ -1,17 +1,61 @@
 #pragma once
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
 #include <map>
+#include <cerrno>
+#include <cstdio>
 #include <cctype>
+#include <limits>
+#include <memory>
 #include <vector>
+#include <random>
+#include <atomic>
+#include <cstring>
+#include <cstdint>
 #include <fstream>
 #include <sstream>
+#include <utility>
+#include <iterator>
 #include <algorithm>
+#include <filesystem>
+#include <string_view>
+#include <type_traits>
 #include "misc.h"
+#include "mappedFile.h"
 #include "stringUtil.h"
 
 namespace util{
 	class Config{
 	public:
+		/*
+		*	Pre-resolved reference to a single key.
+		*	Obtained once through find or handle_for and then used to read or write the value
+		*	without hashing, comparing or allocating. Handles stay valid until the config is cleared.
+		*/
+		class Handle{
+		public:
+			Handle() = default;
+
+			bool valid() const noexcept{ return index != npos; }
+			explicit operator bool() const noexcept{ return valid(); }
+
+		private:
+			friend class Config;
+
+			static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+			std::size_t index = npos;
+
+			explicit Handle(std::size_t index) noexcept : index{index}{}
+		};
+
 		Config() = default;
 
 		Config(const std::string& fileName){
@@ -22,6 +66,8 @@ namespace util{
 			if(clearCache)
 				clear();
 
+			bool wasEmpty = entries.empty();
+
 			if(std::ifstream in{fileName}){
 				std::string currentLine, currentSection;
 
@@ -43,197 +89,967 @@ namespace util{
 					}
 				}
 
+				loaded_from(fileName, wasEmpty);
+
 				return true;
 			}
 
 			return false;
 		}
 
-		bool save_to_file(const std::string& fileName) const{
-			if(data.empty())
-				return true; //Nothing needs to be saved, just returning true
-
-			if(std::ifstream in{fileName}){
-				std::string currentLine;
-				std::vector<std::string> fileContents;
-				ConfigData dataCopy{data};
-				ConfigSection* currentSection = nullptr;
+		/*
+		*	Same as load_from_file but maps the file into memory and parses it in a single pass.
+		*	Sections, keys and values refer directly to the mapped file and are only copied once they are changed.
+		*	The mapping is kept alive by the config (and its copies) until it is cleared.
+		*/
+		bool load_from_mapped_file(const std::string& fileName, bool clearCache){
+			if(clearCache)
+				clear();
 
-				//Saving file but preserving already existing one (except for conflicts)
-				while(std::getline(in, currentLine)){
-					if(currentLine.empty()){
-						fileContents.push_back("");
-					}else if(currentLine[0] == '[' && currentLine.back() == ']'){
-						if(currentSection){
-							if(fileContents.back().empty())
-								fileContents.pop_back();
+			bool wasEmpty = entries.empty();
+			auto file = std::make_shared<MappedFile>(fileName);
 
-							for(const auto& it : *currentSection)
-								fileContents.push_back(it.first + "=" + it.second);
+			if(!file->is_open())
+				return false;
 
-							currentSection->clear();
+			std::string_view contents = file->view();
+			std::string_view currentSection;
 
-							fileContents.push_back("");
-						}
+			while(!contents.empty()){
+				std::string_view currentLine = next_line(contents);
 
-						currentSection = &dataCopy[currentLine.substr(1, currentLine.size() - 2)];
-						fileContents.push_back(currentLine);
-					}else if(currentSection){
-						std::istringstream iss{currentLine};
-						std::string key, value;
-
-						std::getline(iss, key, '=');
+				if(!currentLine.empty() && currentLine[0] != ';'){
+					if(currentLine[0] == '[' && currentLine.back() == ']'){
+						currentSection = currentLine.substr(1, currentLine.size() - 2);
+					}else if(!currentSection.empty()){
+						std::string_view key = currentLine.substr(0, currentLine.find('='));
+						std::string_view value;
 
 						if(!key.empty() && key.size() + 1 < currentLine.size())
 							value = currentLine.substr(key.size() + 1);
 
-						std::string validKey{key};
-
-						//Removing whitespaces from key
-						validKey.erase(std::remove_if(validKey.begin(), validKey.end(), [](char c){
-																							return std::isspace(static_cast<unsigned char>(c));
-																						}),
-									   validKey.end());
-
-						if(validKey[0] == ';'){ //Line is a comment
-							fileContents.push_back(currentLine);
-						}else{
-							auto it = currentSection->find(validKey);
-
-							if(it != currentSection->end()){
-								fileContents.push_back(it->first + "=" + it->second);
-								currentSection->erase(it);
-							}else{
-								fileContents.push_back(validKey + "=" + value);
-							}
-						}
-					}else{
-						if(currentLine[0] == ';')
-							fileContents.push_back(currentLine);
+						set(Text::mapped(currentSection), Text::mapped(key), Text::mapped(value));
 					}
 				}
+			}
 
-				for(const auto& it : *currentSection)
-					fileContents.push_back(it.first + "=" + it.second);
+			mappedFiles.push_back(std::move(file));
+			loaded_from(fileName, wasEmpty);
 
-				currentSection->clear();
+			return true;
+		}
 
-				in.close();
+		/*
+		*	Saves all changes made since the config was last loaded from or saved to the same file.
+		*	Lines of the existing file are kept as they are unless their key changed, new keys are added to their sections.
+		*	The result is written to a temporary file which then replaces the original one, so a crash never leaves a half written file behind.
+		*/
+		bool save_to_file(const std::string& fileName){
+			MappedFile existingFile{fileName};
+			bool onlyChanges = existingFile.is_open() && fileName == syncedFileName;
+			ConfigData changes;
 
-				if(std::ofstream out{fileName}){
-					for(const std::string& line : fileContents)
-						out << line << '\n';
+			for(const Entry& entry : entries){
+				if(entry.dirty || !onlyChanges)
+					changes[std::string{entry.section.view()}].emplace(entry.key.view(), entry.value.view());
+			}
 
-					for(const auto& section : dataCopy){
-						if(!section.second.empty()){
-							out << "\n[" << section.first << "]\n";
+			if(changes.empty())
+				return true; //Nothing needs to be saved, just returning true
 
-							for(const auto& keyValuePair : section.second)
-								out << keyValuePair.first << '=' << keyValuePair.second << '\n';
-						}
-					}
+			std::string contents;
 
-					return true;
+			if(existingFile.is_open()){
+				contents = merge_changes(existingFile.view(), changes);
+				existingFile.close();
+			}else{
+				std::ostringstream out;
+
+				dump(out, changes); //If file doesn't exist yet we can just print it without checking already existing values
+				contents = out.str();
+			}
+
+			if(!replace_file(fileName, contents))
+				return false;
+
+			for(Entry& entry : entries)
+				entry.dirty = false;
+
+			syncedFileName = fileName;
+
+			return true;
+		}
+
+		/*
+		*	Saves the config when going out of scope, so that any number of changes in between only cause a single write.
+		*	Call commit to find out whether saving worked, the destructor can't report errors and ignores them.
+		*/
+		class DeferredSave{
+		public:
+			DeferredSave(Config& config, std::string fileName) : config{config}, fileName{std::move(fileName)}{}
+
+			DeferredSave(const DeferredSave&) = delete;
+			DeferredSave& operator=(const DeferredSave&) = delete;
+
+			~DeferredSave(){
+				if(!committed){
+					try{
+						config.save_to_file(fileName);
+					}catch(...){}
 				}
+			}
+
+			//Saves now instead of in the destructor
+			bool commit(){
+				committed = true;
+
+				return config.save_to_file(fileName);
+			}
+
+		private:
+			Config& config;
+			std::string fileName;
+			bool committed = false;
+		};
+
+		/*
+		*	Writes the parsed state to a binary cache that load_from_cache can use without parsing or hashing anything.
+		*	The cache contains the entries, the lookup index and a string table and records the size and modification time
+		*	of sourceFileName, it's ignored as soon as that file changes.
+		*	Uses the native byte order and is only meant to be read on the machine that wrote it.
+		*/
+		bool save_to_cache(const std::string& cacheFileName, const std::string& sourceFileName) const{
+			CacheHeader header{};
 
+			if(!source_stamp(sourceFileName, header.sourceSize, header.sourceTime))
 				return false;
-			}else{
-				std::ofstream out{fileName};
 
-				dump(out); //If file doesn't exist yet we can just print it without checking already existing values
+			std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+			header.version = cacheVersion;
+			header.entryCount = static_cast<std::uint32_t>(entries.size());
+			header.indexSize = index.size();
+
+			std::string strings;
+			std::vector<CacheEntry> cacheEntries;
+			std::vector<CacheSlot> cacheSlots;
+			std::string_view lastSection;
+			std::uint32_t lastSectionOffset = 0;
+
+			auto add_string = [&strings](std::string_view s){
+				auto offset = static_cast<std::uint32_t>(strings.size());
+
+				strings += s;
+
+				return offset;
+			};
+
+			cacheEntries.reserve(entries.size());
+
+			for(const Entry& entry : entries){
+				CacheEntry& cacheEntry = cacheEntries.emplace_back();
+				std::string_view section = entry.section.view();
+
+				if(cacheEntries.size() == 1 || section != lastSection){ //Entries of the same section usually follow each other and can share the name
+					lastSectionOffset = add_string(section);
+					lastSection = section;
+				}
 
-				return static_cast<bool>(out);
+				cacheEntry.sectionOffset = lastSectionOffset;
+				cacheEntry.sectionSize = static_cast<std::uint32_t>(section.size());
+				cacheEntry.keySize = static_cast<std::uint32_t>(entry.key.view().size());
+				cacheEntry.keyOffset = add_string(entry.key.view());
+				cacheEntry.valueSize = static_cast<std::uint32_t>(entry.value.view().size());
+				cacheEntry.valueOffset = add_string(entry.value.view());
 			}
+
+			cacheSlots.reserve(index.size());
+
+			for(const IndexSlot& slot : index)
+				cacheSlots.push_back(CacheSlot{slot.hash, slot.entry == Handle::npos ? CacheSlot::empty : slot.entry});
+
+			std::string contents;
+
+			contents.reserve(sizeof(header) + cacheEntries.size() * sizeof(CacheEntry) + cacheSlots.size() * sizeof(CacheSlot) + strings.size());
+			contents.append(reinterpret_cast<const char*>(&header), sizeof(header));
+			contents.append(reinterpret_cast<const char*>(cacheEntries.data()), cacheEntries.size() * sizeof(CacheEntry));
+			contents.append(reinterpret_cast<const char*>(cacheSlots.data()), cacheSlots.size() * sizeof(CacheSlot));
+			contents += strings;
+
+			return replace_file(cacheFileName, contents);
+		}
+
+		//Maps a cache written by save_to_cache, if it's missing or outdated the source file is loaded instead and the cache is rewritten
+		bool load_from_cache(const std::string& cacheFileName, const std::string& sourceFileName){
+			clear();
+
+			if(map_cache(cacheFileName, sourceFileName))
+				return true;
+
+			if(!load_from_mapped_file(sourceFileName, true))
+				return false;
+
+			save_to_cache(cacheFileName, sourceFileName); //Failing to update the cache only costs time on the next start
+
+			return true;
 		}
 
 		void clear(){
-			data.clear();
+			entries.clear();
+			index.clear();
+			mappedFiles.clear();
+			syncedFileName.clear();
 		}
 
 		void dump(std::ostream& out) const{
-			for(const auto& section : data){
-				out << '[' << section.first << "]\n";
+			dump(out, sorted_data());
+		}
 
-				for(const auto& keyValuePair : section.second)
-					out << keyValuePair.first << '=' << keyValuePair.second << '\n';
+		//Returns a handle to an existing key or an invalid handle if the key doesn't exist
+		Handle find(std::string_view section, std::string_view key) const noexcept{
+			return Handle{find_entry(section, key, hash_key(section, key))};
+		}
 
-				out << '\n';
-			}
+		//Returns a handle to the key, adding it with the default value first if it doesn't exist yet
+		Handle handle_for(std::string_view section, std::string_view key, std::string_view defaultValue){
+			std::size_t hash = hash_key(section, key);
+			std::size_t entry = find_entry(section, key, hash);
+
+			if(entry == Handle::npos)
+				entry = add_entry(Text{section}, Text{key}, Text{defaultValue}, hash);
+
+			return Handle{entry};
 		}
 
-		std::string get(const std::string& section, const std::string& key, const std::string& defaultValue){
-			std::string validKey{key};
+		std::string_view get(Handle handle) const noexcept{
+			return entries[handle.index].value.view();
+		}
 
-			//Removing whitespaces from key
-			validKey.erase(std::remove_if(validKey.begin(), validKey.end(), [](char c){
-																				return std::isspace(static_cast<unsigned char>(c));
-																			}),
-						   validKey.end());
+		void set(Handle handle, std::string_view value){
+			entries[handle.index].set_value(value);
+		}
 
-			auto configSection = data.find(section);
+		std::string get(std::string_view section, std::string_view key, std::string_view defaultValue){
+			return std::string{get(handle_for(section, key, defaultValue))};
+		}
 
-			if(configSection != data.end()){
+		std::string get(std::string_view section, std::string_view key, const std::string& defaultValue){
+			return get(section, key, std::string_view{defaultValue});
+		}
 
-				auto keyValuePair = configSection->second.find(validKey);
+		std::string get(std::string_view section, std::string_view key, const char* defaultValue){
+			return get(section, key, std::string_view{defaultValue});
+		}
 
-				if(keyValuePair != configSection->second.end())
-					return keyValuePair->second;
-			}
+		//Const lookups never add missing keys, which makes them safe to call concurrently on a shared config
 
-			set(section, validKey, defaultValue);
+		std::string get(std::string_view section, std::string_view key, std::string_view defaultValue) const{
+			Handle handle = find(section, key);
 
-			return defaultValue;
+			return std::string{handle ? get(handle) : defaultValue};
 		}
 
-		std::string get(const std::string& section, const std::string& key, const char* defaultValue){
-			return get(section, key, std::string{defaultValue});
+		std::string get(std::string_view section, std::string_view key, const std::string& defaultValue) const{
+			return get(section, key, std::string_view{defaultValue});
 		}
 
-		void set(const std::string& section, const std::string& key, const std::string& value){
-			std::string validKey{key};
+		std::string get(std::string_view section, std::string_view key, const char* defaultValue) const{
+			return get(section, key, std::string_view{defaultValue});
+		}
 
-			//Removing whitespaces from key
-			validKey.erase(std::remove_if(validKey.begin(), validKey.end(), [](char c){
-																				return std::isspace(static_cast<unsigned char>(c));
-																			}),
-						   validKey.end());
+		void set(std::string_view section, std::string_view key, std::string_view value){
+			std::size_t hash = hash_key(section, key);
+			std::size_t entry = find_entry(section, key, hash);
 
-			data[section][validKey] = value;
+			if(entry != Handle::npos)
+				entries[entry].set_value(value);
+			else
+				add_entry(Text{section}, Text{key}, Text{value}, hash);
 		}
 
-		void set(const std::string& section, const std::string& key, const char* value){
-			set(section, key, std::string{value});
+		void set(std::string_view section, std::string_view key, const std::string& value){
+			set(section, key, std::string_view{value});
+		}
+
+		void set(std::string_view section, std::string_view key, const char* value){
+			set(section, key, std::string_view{value});
 		}
 
 		template<typename T>
-		T get(const std::string& section, const std::string& key, T defaultValue){
-			std::string value{get(section, key, str::to_string(defaultValue))};
-			T result;
+		T get(std::string_view section, std::string_view key, T defaultValue){
+			std::size_t hash = hash_key(section, key);
+			std::size_t entry = find_entry(section, key, hash);
+
+			if(entry == Handle::npos){
+				add_entry(Text{section}, Text{key}, Text{str::to_string(defaultValue)}, hash);
 
-			try{ //Conversion functions like std::stoi might throw an exception, in that case the default value is returned
-				result = str::to_value<T>(value);
-			}catch(...){
-				result = defaultValue;
+				return defaultValue;
 			}
 
-			return result;
+			return get(Handle{entry}, defaultValue);
+		}
+
+		/*
+		*	Typed read through a handle.
+		*	Arithmetic values are parsed only once and cached next to the string until the value is changed,
+		*	so repeated reads of the same type don't convert anything.
+		*/
+		template<typename T>
+		T get(Handle handle, T defaultValue){
+			Entry& entry = entries[handle.index];
+
+			if constexpr(TypedValue::can_store<T>){
+				if(entry.typedValue.holds(&typeTag<T>))
+					return entry.typedValue.valid ? entry.typedValue.load<T>() : defaultValue;
+			}
+
+			str::ParseResult<T> parsed = str::parse_value<T>(entry.value.view());
+
+			if constexpr(TypedValue::can_store<T>)
+				entry.typedValue.store(&typeTag<T>, static_cast<bool>(parsed), parsed.value);
+
+			return parsed ? std::move(parsed.value) : defaultValue;
 		}
 
 		template<typename T>
-		void set(const std::string& section, const std::string& key, T value){
+		T get(std::string_view section, std::string_view key, T defaultValue) const{
+			Handle handle = find(section, key);
+
+			return handle ? get(handle, defaultValue) : defaultValue;
+		}
+
+		//Only fills an empty cache and never replaces a cached value, so this is safe on a config shared between threads
+		template<typename T>
+		T get(Handle handle, T defaultValue) const{
+			return typed_value(entries[handle.index], defaultValue);
+		}
+
+		template<typename T>
+		void set(std::string_view section, std::string_view key, T value){
 			set(section, key, str::to_string(value));
 		}
 
 	private:
+		friend class LayeredConfig;
+
 		using ConfigSection = std::map<std::string, std::string, str::CaseInsensitiveLess>;
 		using ConfigData = std::map<std::string, ConfigSection, str::CaseInsensitiveLess>;
 
-		ConfigData data;
+		//String that either refers to a mapped file or owns its characters
+		class Text{
+		public:
+			Text() = default;
+			explicit Text(std::string_view s) : owned{s}, isOwned{true}{}
+
+			static Text mapped(std::string_view s) noexcept{
+				Text result;
+
+				result.mappedView = s;
+
+				return result;
+			}
+
+			std::string_view view() const noexcept{ return isOwned ? std::string_view{owned} : mappedView; }
+			bool is_owned() const noexcept{ return isOwned; }
+
+			Text& operator=(std::string_view s){
+				owned = s;
+				mappedView = {};
+				isOwned = true;
+
+				return *this;
+			}
+
+		private:
+			std::string owned;
+			std::string_view mappedView;
+			bool isOwned = false;
+		};
+
+		/*
+		*	Parsed value of the type that was last requested from an entry.
+		*	Const reads may fill an empty cache from several threads at once, the first one claims it with fillingTag,
+		*	writes the value and then publishes the type. A published value never changes until the entry is changed.
+		*/
+		struct TypedValue{
+			template<typename T>
+			static constexpr bool can_store = std::is_arithmetic_v<T> && sizeof(T) <= sizeof(long double);
+
+			static inline const char fillingTag = 0;
+
+			std::atomic<const void*> type = nullptr; //Address of the type tag of the cached type or null if nothing is cached
+			bool valid = false; //Whether the string could be converted to that type at all
+			alignas(long double) unsigned char storage[sizeof(long double)];
+
+			TypedValue() = default;
+
+			TypedValue(const TypedValue& other) noexcept{
+				*this = other;
+			}
+
+			TypedValue& operator=(const TypedValue& other) noexcept{
+				const void* otherType = other.type.load(std::memory_order_acquire);
+
+				if(otherType == &fillingTag){
+					type.store(nullptr, std::memory_order_relaxed);
+				}else{
+					std::memcpy(storage, other.storage, sizeof(storage));
+					valid = other.valid;
+					type.store(otherType, std::memory_order_relaxed);
+				}
+
+				return *this;
+			}
+
+			bool holds(const void* typeTag) const noexcept{
+				return type.load(std::memory_order_acquire) == typeTag;
+			}
+
+			template<typename T>
+			T load() const noexcept{
+				T value;
+
+				std::memcpy(&value, storage, sizeof(T));
+
+				return value;
+			}
+
+			//Requires exclusive access to the entry
+			template<typename T>
+			void store(const void* typeTag, bool isValid, T value) noexcept{
+				std::memcpy(storage, &value, sizeof(T));
+				valid = isValid;
+				type.store(typeTag, std::memory_order_relaxed);
+			}
+
+			//Does nothing if another type is cached or another thread is filling the cache
+			template<typename T>
+			void fill(const void* typeTag, bool isValid, T value) noexcept{
+				const void* expected = nullptr;
+
+				if(type.compare_exchange_strong(expected, &fillingTag, std::memory_order_acquire, std::memory_order_relaxed)){
+					std::memcpy(storage, &value, sizeof(T));
+					valid = isValid;
+					type.store(typeTag, std::memory_order_release);
+				}
+			}
+
+			void reset() noexcept{
+				type.store(nullptr, std::memory_order_relaxed);
+			}
+		};
+
+		template<typename T>
+		static inline const char typeTag = 0;
+
+		struct Entry{
+			Text section;
+			Text key; //Stored without whitespaces
+			Text value;
+			mutable TypedValue typedValue;
+			bool dirty = true; //Changed since the config was last loaded from or saved to syncedFileName
+
+			void set_value(std::string_view newValue){
+				value = newValue;
+				typedValue.reset();
+				dirty = true;
+			}
+
+			void set_value(Text&& newValue){
+				value = std::move(newValue);
+				typedValue.reset();
+				dirty = true;
+			}
+		};
+
+		struct IndexSlot{
+			std::size_t hash = 0;
+			std::size_t entry = Handle::npos;
+		};
+
+		std::vector<Entry> entries; //Insertion order, handles are indices into this
+		std::vector<IndexSlot> index; //Open addressing table over entries, size is always zero or a power of two
+		std::vector<std::shared_ptr<const MappedFile>> mappedFiles; //Files that entries may refer to
+		std::string syncedFileName; //File that all entries which aren't dirty are known to be stored in
+
+		static constexpr bool is_space(char c) noexcept{
+			return c == ' ' || (c >= '\t' && c <= '\r');
+		}
+
+		//Case insensitive hash over section and key, whitespaces in the key are skipped just like they are when storing it
+		static std::size_t hash_key(std::string_view section, std::string_view key) noexcept{
+			str::CaseInsensitiveHasher hasher{str::hash_ignore_case(section)};
+
+			for(std::size_t i = 0; i < key.size();){
+				std::size_t start = i;
+
+				while(i < key.size() && !is_space(key[i]))
+					++i;
+
+				hasher.update(key.substr(start, i - start));
+
+				while(i < key.size() && is_space(key[i]))
+					++i;
+			}
+
+			return static_cast<std::size_t>(hasher.finish());
+		}
+
+		static bool section_equals(std::string_view stored, std::string_view section) noexcept{
+			return str::equals_ignore_case(stored, section);
+		}
+
+		static bool key_equals(std::string_view stored, std::string_view key) noexcept{
+			if(key.size() <= stored.size()) //Stored keys never contain whitespaces so only longer keys need to have them skipped
+				return str::equals_ignore_case(stored, key);
+
+			auto it = stored.begin();
+
+			for(char c : key){
+				if(is_space(c))
+					continue;
+
+				if(it == stored.end() || str::to_lower_ascii(*it) != str::to_lower_ascii(c))
+					return false;
+
+				++it;
+			}
+
+			return it == stored.end();
+		}
+
+		std::size_t find_entry(std::string_view section, std::string_view key, std::size_t hash) const noexcept{
+			if(index.empty())
+				return Handle::npos;
+
+			std::size_t mask = index.size() - 1;
+
+			for(std::size_t i = hash & mask; index[i].entry != Handle::npos; i = (i + 1) & mask){
+				const IndexSlot& slot = index[i];
+
+				if(slot.hash == hash){
+					const Entry& entry = entries[slot.entry];
+
+					if(key_equals(entry.key.view(), key) && section_equals(entry.section.view(), section))
+						return slot.entry;
+				}
+			}
+
+			return Handle::npos;
+		}
+
+		void set(Text&& section, Text&& key, Text&& value){
+			std::size_t hash = hash_key(section.view(), key.view());
+			std::size_t entry = find_entry(section.view(), key.view(), hash);
+
+			if(entry != Handle::npos)
+				entries[entry].set_value(std::move(value));
+			else
+				add_entry(std::move(section), std::move(key), std::move(value), hash);
+		}
+
+		std::size_t add_entry(Text&& section, Text&& key, Text&& value, std::size_t hash){
+			if((entries.size() + 1) * 2 > index.size())
+				rehash(std::max<std::size_t>(index.size() * 2, 16));
+
+			std::string_view keyView = key.view();
+
+			if(std::any_of(keyView.begin(), keyView.end(), is_space)){
+				std::string validKey;
+
+				validKey.reserve(keyView.size());
+
+				//Removing whitespaces from key
+				std::copy_if(keyView.begin(), keyView.end(), std::back_inserter(validKey), [](char c){ return !is_space(c); });
+
+				key = validKey;
+			}
+
+			entries.push_back(Entry{std::move(section), std::move(key), std::move(value), {}, true});
+			insert_slot(hash, entries.size() - 1);
+
+			return entries.size() - 1;
+		}
+
+		void insert_slot(std::size_t hash, std::size_t entry) noexcept{
+			std::size_t mask = index.size() - 1;
+			std::size_t i = hash & mask;
+
+			while(index[i].entry != Handle::npos)
+				i = (i + 1) & mask;
+
+			index[i] = IndexSlot{hash, entry};
+		}
+
+		void rehash(std::size_t size){
+			std::vector<IndexSlot> oldIndex{std::move(index)};
+
+			index.assign(size, IndexSlot{});
+
+			for(const IndexSlot& slot : oldIndex){
+				if(slot.entry != Handle::npos)
+					insert_slot(slot.hash, slot.entry);
+			}
+		}
+
+		template<typename T>
+		static T typed_value(const Entry& entry, T defaultValue){
+			if constexpr(TypedValue::can_store<T>){
+				if(entry.typedValue.holds(&typeTag<T>))
+					return entry.typedValue.valid ? entry.typedValue.load<T>() : defaultValue;
+			}
+
+			str::ParseResult<T> parsed = str::parse_value<T>(entry.value.view());
+
+			if constexpr(TypedValue::can_store<T>)
+				entry.typedValue.fill(&typeTag<T>, static_cast<bool>(parsed), parsed.value);
+
+			return parsed ? std::move(parsed.value) : defaultValue;
+		}
+
+		//Entries loaded into an empty config match the file, otherwise it's unknown which file they belong to
+		void loaded_from(const std::string& fileName, bool wasEmpty){
+			if(wasEmpty){
+				for(Entry& entry : entries)
+					entry.dirty = false;
+
+				syncedFileName = fileName;
+			}else{
+				syncedFileName.clear();
+			}
+		}
+
+		//Removes the first line from s and returns it without the line break
+		static std::string_view next_line(std::string_view& s) noexcept{
+			const void* newline = std::memchr(s.data(), '\n', s.size());
+			std::size_t lineLength = newline ? static_cast<const char*>(newline) - s.data() : s.size();
+			std::string_view line = s.substr(0, lineLength);
+
+			s.remove_prefix(std::min(lineLength + 1, s.size()));
+
+			return line;
+		}
+
+		static void dump(std::ostream& out, const ConfigData& data){
+			for(const auto& section : data){
+				out << '[' << section.first << "]\n";
+
+				for(const auto& keyValuePair : section.second)
+					out << keyValuePair.first << '=' << keyValuePair.second << '\n';
+
+				out << '\n';
+			}
+		}
+
+		//Applies changes to the contents of an existing file, untouched lines are copied as they are
+		static std::string merge_changes(std::string_view file, ConfigData& changes){
+			std::string result;
+			std::size_t blankLines = 0; //Blank lines are written lazily so that new keys end up before the ones separating sections
+			ConfigSection* currentSection = nullptr;
+			bool inSection = false;
+
+			result.reserve(file.size());
+
+			auto write_line = [&](std::string_view line){
+				result.append(blankLines, '\n');
+				result.append(line);
+				result.push_back('\n');
+				blankLines = 0;
+			};
+
+			auto write_remaining_keys = [&](){
+				if(!currentSection || currentSection->empty())
+					return;
+
+				std::size_t trailingBlankLines = std::exchange(blankLines, 0);
+
+				for(const auto& it : *currentSection)
+					write_line(it.first + "=" + it.second);
+
+				currentSection->clear();
+				blankLines = trailingBlankLines;
+			};
+
+			while(!file.empty()){
+				std::string_view currentLine = next_line(file);
+
+				if(currentLine.empty()){
+					++blankLines;
+				}else if(currentLine[0] == '[' && currentLine.back() == ']'){
+					if(inSection){
+						write_remaining_keys();
+						blankLines = std::max<std::size_t>(blankLines, 1);
+					}
+
+					auto it = changes.find(std::string{currentLine.substr(1, currentLine.size() - 2)});
+
+					currentSection = it != changes.end() ? &it->second : nullptr;
+					inSection = true;
+					write_line(currentLine);
+				}else if(currentSection){
+					std::string validKey{currentLine.substr(0, currentLine.find('='))};
+
+					//Removing whitespaces from key
+					validKey.erase(std::remove_if(validKey.begin(), validKey.end(), is_space), validKey.end());
+
+					auto it = validKey.empty() || validKey[0] == ';' ? currentSection->end() : currentSection->find(validKey);
+
+					if(it != currentSection->end()){
+						write_line(it->first + "=" + it->second);
+						currentSection->erase(it);
+					}else{
+						write_line(currentLine); //Comment or unchanged key
+					}
+				}else if(inSection || currentLine[0] == ';'){
+					write_line(currentLine);
+				}
+			}
+
+			write_remaining_keys();
+			result.append(blankLines, '\n');
+
+			for(const auto& section : changes){
+				if(!section.second.empty()){
+					result += "\n[" + section.first + "]\n";
+
+					for(const auto& keyValuePair : section.second)
+						result += keyValuePair.first + "=" + keyValuePair.second + "\n";
+				}
+			}
+
+			return result;
+		}
+
+		/*
+		*	Writes to a temporary file first and then renames it so the file is either completely old or completely new.
+		*	The temporary file is flushed to disk before the rename and the directory after it, so not even a power loss
+		*	can leave an empty file behind. An existing file keeps its permissions.
+		*/
+		static bool replace_file(const std::string& fileName, std::string_view contents){
+			std::string tempFileName = fileName + ".tmp" + std::to_string(std::random_device{}()); //Unique so that several processes can replace the same file
+			std::error_code error;
+
+			if(!write_synced(tempFileName, fileName, contents)){
+				std::filesystem::remove(tempFileName, error);
+
+				return false;
+			}
+
+#ifdef _WIN32
+			if(!MoveFileExA(tempFileName.c_str(), fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)){
+				std::filesystem::remove(tempFileName, error);
+
+				return false;
+			}
+#else
+			if(::rename(tempFileName.c_str(), fileName.c_str()) != 0){
+				std::filesystem::remove(tempFileName, error);
+
+				return false;
+			}
+
+			//Not all file systems can sync directories, since the rename already happened that isn't treated as an error
+			std::string directory = str::path(fileName);
+			int directoryFd = ::open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+			if(directoryFd != -1){
+				::fsync(directoryFd);
+				::close(directoryFd);
+			}
+#endif
+
+			return true;
+		}
+
+#ifdef _WIN32
+		static bool write_synced(const std::string& tempFileName, const std::string&, std::string_view contents){
+			HANDLE file = CreateFileA(tempFileName.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if(file == INVALID_HANDLE_VALUE)
+				return false;
+
+			bool success = true;
+
+			while(success && !contents.empty()){
+				DWORD written = 0;
+				auto chunkSize = static_cast<DWORD>(std::min<std::size_t>(contents.size(), 1 << 30));
+
+				success = WriteFile(file, contents.data(), chunkSize, &written, nullptr) && written > 0;
+				contents.remove_prefix(written);
+			}
+
+			success = success && FlushFileBuffers(file);
+
+			return CloseHandle(file) && success;
+		}
+#else
+		static bool write_synced(const std::string& tempFileName, const std::string& fileName, std::string_view contents){
+			struct stat existing;
+			bool exists = ::stat(fileName.c_str(), &existing) == 0;
+			int fd = ::open(tempFileName.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, exists ? 0600 : 0666); //New files get the default permissions
+
+			if(fd == -1)
+				return false;
+
+			bool success = !exists || ::fchmod(fd, existing.st_mode & 07777) == 0;
+
+			while(success && !contents.empty()){
+				ssize_t written = ::write(fd, contents.data(), contents.size());
+
+				if(written > 0)
+					contents.remove_prefix(static_cast<std::size_t>(written));
+				else
+					success = written == -1 && errno == EINTR;
+			}
+
+			success = success && ::fsync(fd) == 0;
+
+			return ::close(fd) == 0 && success;
+		}
+#endif
+
+		struct CacheHeader{
+			char magic[8];
+			std::uint32_t version;
+			std::uint32_t entryCount;
+			std::uint64_t indexSize;
+			std::uint64_t sourceSize;
+			std::int64_t sourceTime;
+		};
+
+		//Offsets are relative to the string table following the index
+		struct CacheEntry{
+			std::uint32_t sectionOffset;
+			std::uint32_t sectionSize;
+			std::uint32_t keyOffset;
+			std::uint32_t keySize;
+			std::uint32_t valueOffset;
+			std::uint32_t valueSize;
+		};
+
+		struct CacheSlot{
+			static constexpr std::uint64_t empty = std::numeric_limits<std::uint64_t>::max();
+
+			std::uint64_t hash;
+			std::uint64_t entry;
+		};
+
+		static constexpr char cacheMagic[8] = {'U', 'T', 'I', 'L', 'C', 'F', 'G', '\0'};
+		static constexpr std::uint32_t cacheVersion = 2; //Needs to change whenever the layout or hash_key change
+
+		static bool source_stamp(const std::string& fileName, std::uint64_t& size, std::int64_t& time){
+			std::error_code error;
+
+			size = std::filesystem::file_size(fileName, error);
+
+			if(error)
+				return false;
+
+			time = static_cast<std::int64_t>(std::filesystem::last_write_time(fileName, error).time_since_epoch().count());
+
+			return !error;
+		}
+
+		bool map_cache(const std::string& cacheFileName, const std::string& sourceFileName){
+			auto file = std::make_shared<MappedFile>(cacheFileName);
+			CacheHeader header;
+			std::uint64_t sourceSize;
+			std::int64_t sourceTime;
+
+			if(!file->is_open() || file->size() < sizeof(header) || !source_stamp(sourceFileName, sourceSize, sourceTime))
+				return false;
+
+			std::memcpy(&header, file->data(), sizeof(header));
+
+			if(std::memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion ||
+			   header.sourceSize != sourceSize || header.sourceTime != sourceTime || header.indexSize > file->size()){
+				return false;
+			}
+
+			//Sizes are computed in 64 bits so that a corrupt header can't wrap them around
+			std::uint64_t entriesOffset = sizeof(header);
+			std::uint64_t slotsOffset = entriesOffset + std::uint64_t{header.entryCount} * sizeof(CacheEntry);
+			std::uint64_t stringsOffset = slotsOffset + header.indexSize * sizeof(CacheSlot);
+
+			if(stringsOffset > file->size() || (header.indexSize & (header.indexSize - 1)) != 0 || std::uint64_t{header.entryCount} * 2 > header.indexSize)
+				return false;
+
+			std::string_view strings = file->view().substr(static_cast<std::size_t>(stringsOffset));
+			auto entry_at = [&](std::size_t i){
+				CacheEntry cacheEntry;
+
+				std::memcpy(&cacheEntry, file->data() + entriesOffset + i * sizeof(CacheEntry), sizeof(CacheEntry));
+
+				return cacheEntry;
+			};
+			auto slot_at = [&](std::size_t i){
+				CacheSlot slot;
+
+				std::memcpy(&slot, file->data() + slotsOffset + i * sizeof(CacheSlot), sizeof(CacheSlot));
+
+				return slot;
+			};
+			auto string_at = [strings](std::uint32_t offset, std::uint32_t size){
+				return offset <= strings.size() && size <= strings.size() - offset;
+			};
+
+			//Everything is checked before anything refers to the file
+			for(std::size_t i = 0; i < header.entryCount; ++i){
+				CacheEntry cacheEntry = entry_at(i);
+
+				if(!string_at(cacheEntry.sectionOffset, cacheEntry.sectionSize) || !string_at(cacheEntry.keyOffset, cacheEntry.keySize) || !string_at(cacheEntry.valueOffset, cacheEntry.valueSize))
+					return false;
+			}
+
+			for(std::size_t i = 0; i < header.indexSize; ++i){
+				CacheSlot slot = slot_at(i);
+
+				if(slot.entry != CacheSlot::empty && slot.entry >= header.entryCount)
+					return false;
+			}
+
+			entries.reserve(header.entryCount);
+			index.reserve(static_cast<std::size_t>(header.indexSize));
+
+			for(std::size_t i = 0; i < header.entryCount; ++i){
+				CacheEntry cacheEntry = entry_at(i);
+
+				entries.push_back(Entry{Text::mapped(strings.substr(cacheEntry.sectionOffset, cacheEntry.sectionSize)),
+										Text::mapped(strings.substr(cacheEntry.keyOffset, cacheEntry.keySize)),
+										Text::mapped(strings.substr(cacheEntry.valueOffset, cacheEntry.valueSize)),
+										{}, false});
+			}
+
+			for(std::size_t i = 0; i < header.indexSize; ++i){
+				CacheSlot slot = slot_at(i);
+
+				index.push_back(IndexSlot{static_cast<std::size_t>(slot.hash), slot.entry == CacheSlot::empty ? Handle::npos : static_cast<std::size_t>(slot.entry)});
+			}
+
+			mappedFiles.push_back(std::move(file));
+			syncedFileName = sourceFileName;
+
+			return true;
+		}
+
+		//Builds sorted maps of all sections and keys for output
+		ConfigData sorted_data() const{
+			ConfigData result;
+
+			for(const Entry& entry : entries)
+				result[std::string{entry.section.view()}].emplace(entry.key.view(), entry.value.view());
+
+			return result;
+		}
 	};
 
 	//Making sure the right overload is being used for std::string
 	template<>
-	inline std::string Config::get(const std::string& section, const std::string& key, std::string defaultValue){
+	inline std::string Config::get(std::string_view section, std::string_view key, std::string defaultValue){
+		return get(section, key, defaultValue);
+	}
+
+	template<>
+	inline std::string Config::get(std::string_view section, std::string_view key, std::string defaultValue) const{
 		return get(section, key, defaultValue);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include "vecArray.h"
+#include "mathUtil.h"
+#include "simdLanes.h"
+
+/*
+*	Approximate math functions that trade precision for speed, each in a scalar form and a batched form over float spans.
+*	Errors are relative to the exact result of the float input unless stated otherwise and were measured over the documented range.
+*	None of the functions handle NaN inputs, the results for them are unspecified.
+*/
+
+namespace util::math::fast{
+#define UTIL_KERNEL_TARGET
+	namespace baseline{
+#ifdef UTIL_SSE2
+		using Lane = simd::Sse2Lane;
+#else
+		using Lane = simd::ScalarLane;
+#endif
+
+#include "fastMath.inl"
+	}
+#undef UTIL_KERNEL_TARGET
+
+#ifdef UTIL_AVX2_DISPATCH
+#define UTIL_KERNEL_TARGET UTIL_TARGET_AVX2
+	namespace avx2{
+		using Lane = simd::Avx2Lane;
+
+#include "fastMath.inl"
+	}
+#undef UTIL_KERNEL_TARGET
+#endif
+
+	//Calls func with the kernels for the best instruction set the CPU supports
+	template<typename Func>
+	void dispatch(Func&& func){
+#ifdef UTIL_AVX2_DISPATCH
+		if(simd::has_avx2())
+			return func(avx2::Kernels{}, avx2::Lane{});
+#endif
+		func(baseline::Kernels{}, baseline::Lane{});
+	}
+
+#define UTIL_FAST_MATH(kernel, ...) dispatch([&](auto kernels, auto lane){ \
+		using Lane = decltype(lane); \
+		kernels.template kernel<simd::ScalarLane>(kernels.template kernel<Lane>(0, __VA_ARGS__), __VA_ARGS__); \
+	})
+
+#define UTIL_FAST_MATH_MAP(function, ...) dispatch([&](auto kernels, auto lane){ \
+		using Lane = decltype(lane); \
+		using Function = typename decltype(kernels)::function; \
+		kernels.template map<simd::ScalarLane, Function>(kernels.template map<Lane, Function>(0, __VA_ARGS__), __VA_ARGS__); \
+	})
+
+	// Reciprocal square root, x must be positive
+
+	//Relative error below 3.7e-4, or 1.8e-3 without SSE
+	inline float rsqrt_approx(float x) noexcept{ return baseline::Kernels::RsqrtApprox::apply<simd::ScalarLane>(x); }
+
+	//Relative error below 5e-7, or 5e-6 without SSE
+	inline float rsqrt(float x) noexcept{ return baseline::Kernels::Rsqrt::apply<simd::ScalarLane>(x); }
+
+	//Same as v / v.length() with the error of rsqrt, zero vectors stay zero
+	inline Vec2f normalize(const Vec2f v) noexcept{
+		float scale = rsqrt(std::max(v.length_sq(), std::numeric_limits<float>::min()));
+
+		return {v.x * scale, v.y * scale};
+	}
+
+	inline Vec3f normalize(const Vec3f v) noexcept{
+		float scale = rsqrt(std::max(v.length_sq(), std::numeric_limits<float>::min()));
+
+		return {v.x * scale, v.y * scale, v.z * scale};
+	}
+
+	// Trigonometry and exponential
+
+	//Absolute error below 1e-7 for |x| <= 8192, the argument reduction loses precision beyond that
+	inline float sin(float x) noexcept{ return baseline::Kernels::Sin::apply<simd::ScalarLane>(x); }
+	inline float cos(float x) noexcept{ return baseline::Kernels::Cos::apply<simd::ScalarLane>(x); }
+
+	//Absolute error below 3e-7 radians, atan2(0, -0) is 0 instead of pi
+	inline float atan2(float y, float x) noexcept{ return baseline::Kernels::Atan2::apply<simd::ScalarLane>(y, x); }
+
+	//Relative error below 1e-7, returns infinity above 88.72 and 0 below -86.5 instead of denormals
+	inline float exp(float x) noexcept{ return baseline::Kernels::Exp::apply<simd::ScalarLane>(x); }
+
+	// Batched forms with the same error bounds, out may be the same as the input
+
+	inline void rsqrt_approx(const float* in, float* out, std::size_t n) noexcept{ UTIL_FAST_MATH_MAP(RsqrtApprox, in, out, n); }
+	inline void rsqrt(const float* in, float* out, std::size_t n) noexcept{ UTIL_FAST_MATH_MAP(Rsqrt, in, out, n); }
+	inline void sin(const float* in, float* out, std::size_t n) noexcept{ UTIL_FAST_MATH_MAP(Sin, in, out, n); }
+	inline void cos(const float* in, float* out, std::size_t n) noexcept{ UTIL_FAST_MATH_MAP(Cos, in, out, n); }
+	inline void exp(const float* in, float* out, std::size_t n) noexcept{ UTIL_FAST_MATH_MAP(Exp, in, out, n); }
+	inline void atan2(const float* y, const float* x, float* out, std::size_t n) noexcept{ UTIL_FAST_MATH(atan2, y, x, out, n); }
+
+	//Same as math::batch::normalize but with the error of rsqrt
+	inline void normalize(const Vec3fArray& a, Vec3fArray& out){
+		out.resize(a.size());
+		UTIL_FAST_MATH(normalize, a.lanes(), out.lanes(), a.size());
+	}
+
+#undef UTIL_FAST_MATH_MAP
+#undef UTIL_FAST_MATH
+}
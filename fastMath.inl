@@ -0,0 +1,168 @@
+//Approximations shared by all instruction sets, included once per lane type with Lane and UTIL_KERNEL_TARGET defined
+
+/*
+*	Every function is a nested struct with a static apply template so that the span loops can take it as a type.
+*	Rounding to an integer adds and subtracts 1.5 * 2^23, afterwards the low bits of the sum are the integer itself.
+*/
+
+struct Kernels{
+	struct RsqrtApprox{
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type apply(typename L::Type x) noexcept{
+			return L::rsqrt(x);
+		}
+	};
+
+	//One Newton-Raphson step on top of the estimate
+	struct Rsqrt{
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type apply(typename L::Type x) noexcept{
+			auto estimate = L::rsqrt(x);
+
+			return L::mul(L::mul(L::set(0.5f), estimate), L::sub(L::set(3.0f), L::mul(L::mul(x, estimate), estimate)));
+		}
+	};
+
+	struct SinCos{
+		//Result for the quadrant in the lowest two bits of quadrant, reduced must be in [-pi/4, pi/4]
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type evaluate(typename L::Type reduced, typename L::Type quadrant) noexcept{
+			auto r2 = L::mul(reduced, reduced);
+			auto s = L::add(L::mul(L::set(-1.9515295891e-4f), r2), L::set(8.3321608736e-3f));
+			auto c = L::add(L::mul(L::set(2.443315711809948e-5f), r2), L::set(-1.388731625493765e-3f));
+
+			s = L::add(L::mul(s, r2), L::set(-1.6666654611e-1f));
+			s = L::add(L::mul(L::mul(s, r2), reduced), reduced);
+			c = L::add(L::mul(c, r2), L::set(4.166664568298827e-2f));
+			c = L::add(L::sub(L::mul(L::mul(c, r2), r2), L::mul(L::set(0.5f), r2)), L::set(1.0f));
+
+			auto useCos = L::template shift_right_int<31>(L::template shift_left_int<31>(quadrant));
+			auto sign = L::template shift_left_int<30>(L::bit_and(quadrant, L::set_bits(2)));
+
+			return L::bit_xor(L::select(useCos, c, s), sign);
+		}
+
+		//x = quadrant * pi/2 + reduced, the subtraction is split into three parts so it stays exact
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type reduce(typename L::Type x, typename L::Type& quadrant) noexcept{
+			auto magic = L::set(0x1.8p23f);
+
+			quadrant = L::add(L::mul(x, L::set(0.63661977236758134f)), magic);
+
+			auto k = L::sub(quadrant, magic);
+			auto reduced = L::sub(x, L::mul(k, L::set(1.5703125f)));
+
+			reduced = L::sub(reduced, L::mul(k, L::set(4.837512969970703125e-4f)));
+
+			return L::sub(reduced, L::mul(k, L::set(7.54978995489188216e-8f)));
+		}
+	};
+
+	struct Sin{
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type apply(typename L::Type x) noexcept{
+			typename L::Type quadrant;
+			auto reduced = SinCos::reduce<L>(x, quadrant);
+
+			return SinCos::evaluate<L>(reduced, quadrant);
+		}
+	};
+
+	//cos(x) = sin(x + pi/2), which is one quadrant further
+	struct Cos{
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type apply(typename L::Type x) noexcept{
+			typename L::Type quadrant;
+			auto reduced = SinCos::reduce<L>(x, quadrant);
+
+			return SinCos::evaluate<L>(reduced, L::add_int(quadrant, L::set_bits(1)));
+		}
+	};
+
+	struct Atan2{
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type apply(typename L::Type y, typename L::Type x) noexcept{
+			auto signBit = L::set(-0.0f);
+			auto absX = L::bit_andnot(signBit, x);
+			auto absY = L::bit_andnot(signBit, y);
+			auto ratio = L::div(L::min(absX, absY), L::max(L::max(absX, absY), L::set(std::numeric_limits<float>::min())));
+
+			//atan(a) = pi/4 + atan((a - 1) / (a + 1)) keeps the polynomial argument below tan(pi/8)
+			auto shifted = L::less(L::set(0.41421356f), ratio);
+			auto a = L::select(shifted, L::div(L::sub(ratio, L::set(1.0f)), L::add(ratio, L::set(1.0f))), ratio);
+			auto a2 = L::mul(a, a);
+			auto poly = L::add(L::mul(L::set(8.05374449538e-2f), a2), L::set(-1.38776856032e-1f));
+
+			poly = L::add(L::mul(poly, a2), L::set(1.99777106478e-1f));
+			poly = L::add(L::mul(poly, a2), L::set(-3.33329491539e-1f));
+
+			auto angle = L::add(L::mul(L::mul(poly, a2), a), a);
+
+			angle = L::add(angle, L::bit_and(shifted, L::set(0.78539816339744831f)));
+			angle = L::select(L::less(absX, absY), L::sub(L::set(1.57079632679489662f), angle), angle);
+			angle = L::select(L::less(x, L::set(0.0f)), L::sub(L::set(3.14159265358979324f), angle), angle);
+
+			return L::bit_xor(angle, L::bit_and(y, signBit));
+		}
+	};
+
+	//exp(x) = 2^k * exp(r) with r = x - k * ln(2) in [-ln(2)/2, ln(2)/2]
+	struct Exp{
+		template<typename L>
+		UTIL_KERNEL_TARGET static typename L::Type apply(typename L::Type x) noexcept{
+			auto tooLarge = L::less(L::set(88.72283f), x);
+			auto tooSmall = L::less(x, L::set(-86.5f)); //Below this 2^k wouldn't be a normal float any more
+			auto magic = L::set(0x1.8p23f);
+			auto clamped = L::min(L::max(x, L::set(-86.5f)), L::set(88.72283f));
+			auto rounded = L::add(L::mul(clamped, L::set(1.44269504088896341f)), magic);
+			auto k = L::sub(rounded, magic);
+			auto r = L::sub(L::sub(clamped, L::mul(k, L::set(0.693359375f))), L::mul(k, L::set(-2.12194440e-4f)));
+			auto poly = L::add(L::mul(L::set(1.9875691500e-4f), r), L::set(1.3981999507e-3f));
+
+			poly = L::add(L::mul(poly, r), L::set(8.3334519073e-3f));
+			poly = L::add(L::mul(poly, r), L::set(4.1665795894e-2f));
+			poly = L::add(L::mul(poly, r), L::set(1.6666665459e-1f));
+			poly = L::add(L::mul(poly, r), L::set(5.0000001201e-1f));
+			poly = L::add(L::add(L::mul(L::mul(poly, r), r), r), L::set(1.0f));
+
+			auto result = L::add_int(poly, L::template shift_left_int<23>(rounded)); //Adds k to the exponent
+
+			result = L::select(tooLarge, L::set(std::numeric_limits<float>::infinity()), result);
+
+			return L::bit_andnot(tooSmall, result);
+		}
+	};
+
+	template<typename L, typename Func>
+	UTIL_KERNEL_TARGET static std::size_t map(std::size_t i, const float* in, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width)
+			L::store(out + i, Func::template apply<L>(L::load(in + i)));
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t atan2(std::size_t i, const float* y, const float* x, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width)
+			L::store(out + i, Atan2::apply<L>(L::load(y + i), L::load(x + i)));
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t normalize(std::size_t i, Vec3fLanes<const float> a, Vec3fLanes<float> out, std::size_t n) noexcept{
+		auto smallest = L::set(std::numeric_limits<float>::min()); //Zero vectors stay zero
+
+		for(; i + L::width <= n; i += L::width){
+			auto x = L::load(a.x + i), y = L::load(a.y + i), z = L::load(a.z + i);
+			auto lengthSq = L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z));
+			auto scale = Rsqrt::apply<L>(L::max(lengthSq, smallest));
+
+			L::store(out.x + i, L::mul(x, scale));
+			L::store(out.y + i, L::mul(y, scale));
+			L::store(out.z + i, L::mul(z, scale));
+		}
+
+		return i;
+	}
+};
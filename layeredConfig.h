@@ -0,0 +1,173 @@
+#pragma once
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include "config.h"
+
+namespace util{
+	/*
+	*	Stack of configs that is looked up in priority order instead of merging all layers into one config.
+	*	Layers are shared and never copied, so the same defaults can be part of many stacks.
+	*	Whenever the layers change a flattened index is built that maps every distinct key to the topmost layer containing it,
+	*	so a lookup costs the same as in a single config no matter how many layers there are.
+	*/
+	class LayeredConfig{
+	public:
+		using Layer = std::shared_ptr<const Config>;
+
+		static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+		LayeredConfig() = default;
+		LayeredConfig(std::vector<Layer> layers) : layerStack{std::move(layers)}{ rebuild_index(); }
+
+		//Adds a layer on top that overrides all existing ones
+		void push_layer(Layer layer){
+			layerStack.push_back(std::move(layer));
+			rebuild_index();
+		}
+
+		//Inserts a layer at the specified priority, 0 being the lowest
+		void insert_layer(std::size_t priority, Layer layer){
+			layerStack.insert(layerStack.begin() + std::min(priority, layerStack.size()), std::move(layer));
+			rebuild_index();
+		}
+
+		bool remove_layer(const Layer& layer){
+			auto it = std::find(layerStack.begin(), layerStack.end(), layer);
+
+			if(it == layerStack.end())
+				return false;
+
+			layerStack.erase(it);
+			rebuild_index();
+
+			return true;
+		}
+
+		void clear(){
+			layerStack.clear();
+			index.clear();
+		}
+
+		const std::vector<Layer>& layers() const noexcept{ return layerStack; }
+
+		//Returns the priority of the layer the value is taken from or npos if no layer contains the key
+		std::size_t layer_of(std::string_view section, std::string_view key) const noexcept{
+			const IndexSlot* slot = find_slot(section, key);
+
+			return slot ? slot->layer : npos;
+		}
+
+		bool has_key(std::string_view section, std::string_view key) const noexcept{
+			return find_slot(section, key) != nullptr;
+		}
+
+		std::string get(std::string_view section, std::string_view key, std::string_view defaultValue) const{
+			const IndexSlot* slot = find_slot(section, key);
+
+			return std::string{slot ? slot->entry->value.view() : defaultValue};
+		}
+
+		std::string get(std::string_view section, std::string_view key, const std::string& defaultValue) const{
+			return get(section, key, std::string_view{defaultValue});
+		}
+
+		std::string get(std::string_view section, std::string_view key, const char* defaultValue) const{
+			return get(section, key, std::string_view{defaultValue});
+		}
+
+		template<typename T>
+		T get(std::string_view section, std::string_view key, T defaultValue) const{
+			const IndexSlot* slot = find_slot(section, key);
+
+			return slot ? Config::typed_value(*slot->entry, defaultValue) : defaultValue;
+		}
+
+		//Merges all layers into a single config, e.g. to save the effective settings
+		Config flatten() const{
+			Config result;
+
+			for(const Layer& layer : layerStack){
+				for(const Config::Entry& entry : layer->entries)
+					result.set(entry.section.view(), entry.key.view(), entry.value.view());
+			}
+
+			return result;
+		}
+
+	private:
+		struct IndexSlot{
+			std::size_t hash = 0;
+			const Config::Entry* entry = nullptr; //Points into a layer, which is immutable and kept alive by layerStack
+			std::size_t layer = npos;
+		};
+
+		std::vector<Layer> layerStack; //Lowest priority first
+		std::vector<IndexSlot> index; //Open addressing table over all distinct keys, size is always zero or a power of two
+
+		const IndexSlot* find_slot(std::string_view section, std::string_view key) const noexcept{
+			return find_slot(section, key, Config::hash_key(section, key));
+		}
+
+		const IndexSlot* find_slot(std::string_view section, std::string_view key, std::size_t hash) const noexcept{
+			if(index.empty())
+				return nullptr;
+
+			std::size_t mask = index.size() - 1;
+
+			for(std::size_t i = hash & mask; index[i].entry; i = (i + 1) & mask){
+				const IndexSlot& slot = index[i];
+
+				if(slot.hash == hash && Config::key_equals(slot.entry->key.view(), key) && Config::section_equals(slot.entry->section.view(), section))
+					return &slot;
+			}
+
+			return nullptr;
+		}
+
+		void rebuild_index(){
+			std::size_t entryCount = 0;
+
+			for(const Layer& layer : layerStack)
+				entryCount += layer->entries.size();
+
+			std::size_t size = 16;
+
+			while(size < entryCount * 2)
+				size *= 2;
+
+			index.assign(size, IndexSlot{});
+
+			std::size_t mask = size - 1;
+
+			//Going from the top so the first layer to add a key is the one that overrides all others
+			for(std::size_t layer = layerStack.size(); layer-- > 0;){
+				const Config& config = *layerStack[layer];
+
+				for(const Config::Entry& entry : config.entries){
+					std::size_t hash = Config::hash_key(entry.section.view(), entry.key.view());
+
+					if(find_slot(entry.section.view(), entry.key.view(), hash))
+						continue;
+
+					std::size_t slot = hash & mask;
+
+					while(index[slot].entry)
+						slot = (slot + 1) & mask;
+
+					index[slot] = IndexSlot{hash, &entry, layer};
+				}
+			}
+		}
+	};
+
+	template<>
+	inline std::string LayeredConfig::get(std::string_view section, std::string_view key, std::string defaultValue) const{
+		return get(section, key, defaultValue);
+	}
+}
@@ -0,0 +1,432 @@
+#pragma once
+
+#include <mutex>
+#include <tuple>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <string_view>
+#include <type_traits>
+#include <condition_variable>
+#include "misc.h"
+#include "stringUtil.h"
+
+namespace util{
+	enum class LogLevel : std::uint8_t{
+		Debug,
+		Info,
+		Warning,
+		Error
+	};
+
+	//What a thread does when its buffer is full
+	enum class LogOverflow{
+		Drop, //The message is discarded and counted in Logger::dropped
+		Block //The thread waits until the background thread has made room
+	};
+
+	/*
+	*	Asynchronous logger writing to a file.
+	*	Every thread gets its own lock-free ring buffer, logging only copies the arguments into it in binary form.
+	*	A background thread formats the messages with str::format and writes everything it collected with a single call.
+	*	Numbers are copied as they are, strings and the format string are copied by value and other types are formatted right away.
+	*	Messages that don't fit into half a buffer are formatted and written by the calling thread with LogOverflow::Block.
+	*	Timestamps are recalibrated against the system clock about once a second so they follow clock adjustments:
+	*
+	*		util::Logger log{"app.log"};
+	*
+	*		log.info("Loaded {1} entries from {2}", count, fileName);
+	*/
+	class Logger{
+	public:
+		Logger(const std::string& fileName, LogOverflow overflow = LogOverflow::Block, std::size_t bufferSize = 64 * 1024,
+			   std::chrono::milliseconds flushInterval = std::chrono::milliseconds{10}) :
+			overflow{overflow}, bufferSize{ring_size(bufferSize)}, flushInterval{flushInterval}{
+			file = std::fopen(fileName.c_str(), "ab");
+
+			if(file){
+				std::setvbuf(file, nullptr, _IONBF, 0); //Batches are already complete, so each one is a single write
+				writerThread = std::thread{&Logger::run, this};
+			}
+		}
+
+		Logger(const Logger&) = delete;
+		Logger& operator=(const Logger&) = delete;
+
+		~Logger(){
+			{
+				std::lock_guard<std::mutex> lock{wakeMutex};
+
+				running = false;
+			}
+
+			wake.notify_one();
+
+			if(writerThread.joinable())
+				writerThread.join();
+
+			if(file){
+				flush();
+				std::fclose(file);
+			}
+		}
+
+		bool is_open() const noexcept{ return file != nullptr; }
+
+		//Messages below this level are ignored before their arguments are captured
+		void set_level(LogLevel level) noexcept{ minLevel.store(level, std::memory_order_relaxed); }
+		LogLevel level() const noexcept{ return minLevel.load(std::memory_order_relaxed); }
+
+		//Number of messages that were discarded with LogOverflow::Drop because a buffer was full or the message didn't fit into one
+		std::uint64_t dropped() const noexcept{ return droppedCount.load(std::memory_order_relaxed); }
+
+		template<typename ... Args>
+		void log(LogLevel level, std::string_view fmt, const Args& ...args){
+			if(level < minLevel.load(std::memory_order_relaxed) || !file)
+				return;
+
+			std::int64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(timestampFormatter.now().time_since_epoch()).count();
+
+			std::apply([&](const auto& ...captured){
+				write_record(level, fmt, time, &decode_record<Stored<std::decay_t<decltype(captured)>>...>, captured...);
+			}, std::tuple<decltype(capture(args))...>{capture(args)...});
+		}
+
+		template<std::size_t N, typename ... Args>
+		void log(LogLevel level, const str::FormatString<N>& fmt, const Args& ...args){
+			log(level, fmt.str(), args...);
+		}
+
+		template<typename Format, typename ... Args>
+		void debug(const Format& fmt, const Args& ...args){ log(LogLevel::Debug, fmt, args...); }
+
+		template<typename Format, typename ... Args>
+		void info(const Format& fmt, const Args& ...args){ log(LogLevel::Info, fmt, args...); }
+
+		template<typename Format, typename ... Args>
+		void warning(const Format& fmt, const Args& ...args){ log(LogLevel::Warning, fmt, args...); }
+
+		template<typename Format, typename ... Args>
+		void error(const Format& fmt, const Args& ...args){ log(LogLevel::Error, fmt, args...); }
+
+		//Writes everything that was logged before the call
+		void flush(){
+			if(file){
+				std::lock_guard<std::mutex> lock{writeMutex};
+
+				write_pending();
+			}
+		}
+
+	private:
+		using Decoder = void(*)(const char* data, std::string_view fmt, std::string& out);
+
+		//Followed by the format string and the encoded arguments
+		struct RecordHeader{
+			std::size_t size; //Including the header and padding
+			std::uint32_t fmtLength;
+			Decoder decode; //Null for padding at the end of the ring
+			std::int64_t time; //Nanoseconds since the epoch of std::chrono::system_clock
+			LogLevel level;
+		};
+
+		//Single producer single consumer queue of records, positions only ever increase and are wrapped when accessing data
+		struct RingBuffer{
+			std::unique_ptr<char[]> data;
+			std::size_t size;
+			alignas(64) std::atomic<std::size_t> head = 0; //Written by the producer
+			alignas(64) std::atomic<std::size_t> tail = 0; //Written by the consumer
+
+			RingBuffer(std::size_t size) : data{new char[size]}, size{size}{}
+		};
+
+		LogOverflow overflow;
+		std::size_t bufferSize;
+		std::chrono::milliseconds flushInterval;
+		std::uint64_t id = nextId.fetch_add(1, std::memory_order_relaxed);
+		std::shared_ptr<const void> lifetime = std::make_shared<char>(); //Threads only keep weak references to tell whether the logger still exists
+		std::atomic<LogLevel> minLevel = LogLevel::Debug;
+		std::atomic<std::uint64_t> droppedCount = 0;
+		std::FILE* file = nullptr;
+		TimestampFormatter timestampFormatter;
+		std::mutex buffersMutex;
+		std::vector<std::shared_ptr<RingBuffer>> buffers;
+		std::mutex writeMutex; //Only one thread may drain the buffers at a time
+		std::string batch;
+		std::mutex wakeMutex;
+		std::condition_variable wake;
+		bool running = true;
+		std::thread writerThread;
+
+		inline static std::atomic<std::uint64_t> nextId = 0;
+		static constexpr std::chrono::seconds calibrationInterval{1};
+
+		static std::size_t ring_size(std::size_t size) noexcept{
+			std::size_t result = 1024;
+
+			while(result < size)
+				result *= 2;
+
+			return result;
+		}
+
+		static constexpr std::size_t align(std::size_t size) noexcept{
+			return (size + alignof(RecordHeader) - 1) & ~(alignof(RecordHeader) - 1);
+		}
+
+		//Numbers are stored as they are, everything else as a string
+		template<typename T>
+		static decltype(auto) capture(const T& value){
+			if constexpr(std::is_arithmetic_v<T> || std::is_convertible_v<const T&, std::string_view>){
+				return (value);
+			}else{
+				std::string result;
+
+				str::format_append(result, "{1}", value);
+
+				return result;
+			}
+		}
+
+		template<typename T>
+		using Stored = std::conditional_t<std::is_arithmetic_v<T>, T, std::string_view>;
+
+		template<typename T>
+		static std::size_t encoded_size(const T& value) noexcept{
+			if constexpr(std::is_arithmetic_v<T>)
+				return sizeof(T);
+			else
+				return sizeof(std::uint32_t) + std::string_view{value}.size();
+		}
+
+		template<typename T>
+		static void encode(char*& out, const T& value) noexcept{
+			if constexpr(std::is_arithmetic_v<T>){
+				std::memcpy(out, &value, sizeof(T));
+				out += sizeof(T);
+			}else{
+				std::string_view s{value};
+				auto length = static_cast<std::uint32_t>(s.size());
+
+				std::memcpy(out, &length, sizeof(length));
+				std::memcpy(out + sizeof(length), s.data(), s.size());
+				out += sizeof(length) + s.size();
+			}
+		}
+
+		template<typename T>
+		static T decode(const char*& data) noexcept{
+			if constexpr(std::is_arithmetic_v<T>){
+				T value;
+
+				std::memcpy(&value, data, sizeof(T));
+				data += sizeof(T);
+
+				return value;
+			}else{
+				std::uint32_t length;
+
+				std::memcpy(&length, data, sizeof(length));
+				data += sizeof(length) + length;
+
+				return {data - length, length};
+			}
+		}
+
+		template<typename ... Ts>
+		static void decode_record([[maybe_unused]] const char* data, std::string_view fmt, std::string& out){
+			std::tuple<Ts...> values{decode<Ts>(data)...}; //Braced initialization is evaluated in order
+
+			std::apply([&](const auto& ...args){ str::format_append(out, fmt, args...); }, values);
+		}
+
+		template<typename ... Ts>
+		static void encode_record(char* out, const RecordHeader& header, std::string_view fmt, const Ts& ...values) noexcept{
+			std::memcpy(out, &header, sizeof(header));
+			std::memcpy(out + sizeof(header), fmt.data(), fmt.size());
+			out += sizeof(header) + fmt.size();
+			(encode(out, values), ...);
+		}
+
+		template<typename ... Ts>
+		void write_record(LogLevel level, std::string_view fmt, std::int64_t time, Decoder decoder, const Ts& ...values){
+			std::size_t size = align(sizeof(RecordHeader) + fmt.size() + (encoded_size(values) + ... + 0));
+			RecordHeader header{size, static_cast<std::uint32_t>(fmt.size()), decoder, time, level};
+			RingBuffer& ring = local_buffer();
+
+			//Larger records could end up next to so much padding that they never fit
+			if(size > ring.size / 2){
+				if(overflow == LogOverflow::Drop){
+					droppedCount.fetch_add(1, std::memory_order_relaxed);
+
+					return;
+				}
+
+				std::unique_ptr<char[]> record{new char[size]};
+
+				encode_record(record.get(), header, fmt, values...);
+				write_directly(record.get());
+
+				return;
+			}
+
+			std::size_t head = ring.head.load(std::memory_order_relaxed);
+			std::size_t offset = head & (ring.size - 1);
+			std::size_t padding = ring.size - offset < size ? ring.size - offset : 0; //Records never wrap around
+
+			while(head + padding + size - ring.tail.load(std::memory_order_acquire) > ring.size){
+				if(overflow == LogOverflow::Drop){
+					droppedCount.fetch_add(1, std::memory_order_relaxed);
+
+					return;
+				}
+
+				wake.notify_one();
+				std::this_thread::yield();
+			}
+
+			if(padding >= sizeof(RecordHeader)){
+				RecordHeader marker{padding, 0, nullptr, 0, level};
+
+				std::memcpy(ring.data.get() + offset, &marker, sizeof(marker));
+			}
+
+			encode_record(ring.data.get() + ((head + padding) & (ring.size - 1)), header, fmt, values...);
+			ring.head.store(head + padding + size, std::memory_order_release);
+		}
+
+		//Writes a single record right away, after everything that is still buffered so the calling thread's messages stay in order
+		void write_directly(const char* record){
+			std::lock_guard<std::mutex> lock{writeMutex};
+
+			write_pending();
+			batch.clear();
+			append_record(record);
+			std::fwrite(batch.data(), 1, batch.size(), file);
+		}
+
+		struct ThreadBuffer{
+			std::uint64_t loggerId; //Ids are never reused, unlike addresses
+			std::weak_ptr<const void> logger;
+			std::shared_ptr<RingBuffer> buffer;
+		};
+
+		//The calling thread's buffer, created on first use
+		RingBuffer& local_buffer(){
+			thread_local std::vector<ThreadBuffer> threadBuffers;
+
+			for(const auto& entry : threadBuffers){
+				if(entry.loggerId == id)
+					return *entry.buffer;
+			}
+
+			//Releases the buffers of loggers that were destroyed since the last one was added
+			threadBuffers.erase(std::remove_if(threadBuffers.begin(), threadBuffers.end(), [](const ThreadBuffer& entry){ return entry.logger.expired(); }), threadBuffers.end());
+
+			auto buffer = std::make_shared<RingBuffer>(bufferSize);
+
+			{
+				std::lock_guard<std::mutex> lock{buffersMutex};
+
+				buffers.push_back(buffer);
+			}
+
+			threadBuffers.push_back({id, lifetime, buffer});
+
+			return *buffer;
+		}
+
+		void run(){
+			std::unique_lock<std::mutex> lock{wakeMutex};
+			auto lastCalibration = std::chrono::steady_clock::now();
+
+			while(running){
+				wake.wait_for(lock, flushInterval);
+				lock.unlock();
+				flush();
+
+				if(std::chrono::steady_clock::now() - lastCalibration >= calibrationInterval){
+					timestampFormatter.calibrate();
+					lastCalibration = std::chrono::steady_clock::now();
+				}
+
+				lock.lock();
+			}
+		}
+
+		//Needs writeMutex to be locked
+		void write_pending(){
+			std::vector<std::shared_ptr<RingBuffer>> current;
+
+			{
+				std::lock_guard<std::mutex> lock{buffersMutex};
+
+				//Buffers that are only referenced here belong to threads that have exited
+				buffers.erase(std::remove_if(buffers.begin(), buffers.end(), [](const auto& buffer){
+					return buffer.use_count() == 1 && buffer->head.load(std::memory_order_acquire) == buffer->tail.load(std::memory_order_relaxed);
+				}), buffers.end());
+
+				current = buffers;
+			}
+
+			batch.clear();
+
+			for(const auto& buffer : current)
+				read_records(*buffer);
+
+			if(!batch.empty())
+				std::fwrite(batch.data(), 1, batch.size(), file);
+		}
+
+		void read_records(RingBuffer& ring){
+			std::size_t head = ring.head.load(std::memory_order_acquire);
+			std::size_t tail = ring.tail.load(std::memory_order_relaxed);
+
+			while(tail != head){
+				std::size_t offset = tail & (ring.size - 1);
+
+				if(ring.size - offset < sizeof(RecordHeader)){ //Too little space left for a padding marker
+					tail += ring.size - offset;
+
+					continue;
+				}
+
+				RecordHeader header;
+
+				std::memcpy(&header, ring.data.get() + offset, sizeof(header));
+
+				if(header.decode)
+					append_record(ring.data.get() + offset);
+
+				tail += header.size;
+			}
+
+			ring.tail.store(tail, std::memory_order_release);
+		}
+
+		//Formats a record that isn't padding into a line of batch
+		void append_record(const char* record){
+			constexpr std::string_view levels[] = {" [Debug] ", " [Info] ", " [Warning] ", " [Error] "};
+			RecordHeader header;
+			char timestamp[80];
+
+			std::memcpy(&header, record, sizeof(header));
+
+			const char* fmt = record + sizeof(header);
+			std::chrono::system_clock::time_point time{std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{header.time})};
+
+			batch.append(timestamp, timestampFormatter.format(time, timestamp, sizeof(timestamp)));
+			batch += levels[static_cast<std::size_t>(header.level)];
+			header.decode(fmt + header.fmtLength, {fmt, header.fmtLength}, batch);
+			batch += '\n';
+		}
+	};
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#include <string>
+#include <cstddef>
+#include <utility>
+#include <string_view>
+
+namespace util{
+	/*
+	*	Read-only view of a whole file mapped into memory
+	*	The contents stay valid for as long as the object is alive and open
+	*/
+	class MappedFile{
+	public:
+		MappedFile() = default;
+
+		MappedFile(const std::string& fileName){
+			open(fileName);
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept{
+			*this = std::move(other);
+		}
+
+		MappedFile& operator=(MappedFile&& other) noexcept{
+			if(this != &other){
+				close();
+
+				fileData = std::exchange(other.fileData, nullptr);
+				fileSize = std::exchange(other.fileSize, 0);
+				isOpen = std::exchange(other.isOpen, false);
+			}
+
+			return *this;
+		}
+
+		~MappedFile(){
+			close();
+		}
+
+		bool is_open() const noexcept{ return isOpen; }
+		const char* data() const noexcept{ return fileData; }
+		std::size_t size() const noexcept{ return fileSize; }
+		std::string_view view() const noexcept{ return {fileData, fileSize}; }
+
+#ifdef _WIN32
+		bool open(const std::string& fileName){
+			close();
+
+			HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+			if(file == INVALID_HANDLE_VALUE)
+				return false;
+
+			LARGE_INTEGER size;
+
+			if(GetFileSizeEx(file, &size)){
+				if(size.QuadPart == 0){ //Empty files cannot be mapped but are still valid
+					isOpen = true;
+				}else{
+					HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+					if(mapping){
+						fileData = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+						fileSize = fileData ? static_cast<std::size_t>(size.QuadPart) : 0;
+						isOpen = fileData != nullptr;
+
+						CloseHandle(mapping); //The view keeps the mapping alive
+					}
+				}
+			}
+
+			CloseHandle(file);
+
+			return isOpen;
+		}
+
+		void close() noexcept{
+			if(fileData)
+				UnmapViewOfFile(fileData);
+
+			fileData = nullptr;
+			fileSize = 0;
+			isOpen = false;
+		}
+#else
+		bool open(const std::string& fileName){
+			close();
+
+			int file = ::open(fileName.c_str(), O_RDONLY);
+
+			if(file == -1)
+				return false;
+
+			struct stat info;
+
+			if(fstat(file, &info) == 0){
+				if(info.st_size == 0){ //Empty files cannot be mapped but are still valid
+					isOpen = true;
+				}else{
+					void* mapping = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+					if(mapping != MAP_FAILED){
+						fileData = static_cast<const char*>(mapping);
+						fileSize = static_cast<std::size_t>(info.st_size);
+						isOpen = true;
+
+						madvise(mapping, fileSize, MADV_SEQUENTIAL);
+					}
+				}
+			}
+
+			::close(file); //The mapping stays valid after closing the descriptor
+
+			return isOpen;
+		}
+
+		void close() noexcept{
+			if(fileData)
+				munmap(const_cast<char*>(fileData), fileSize);
+
+			fileData = nullptr;
+			fileSize = 0;
+			isOpen = false;
+		}
+#endif
+
+	private:
+		const char* fileData = nullptr;
+		std::size_t fileSize = 0;
+		bool isOpen = false;
+	};
+}
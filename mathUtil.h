@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cmath>
-#include <cstdlib>
+#include <cstddef>
 #include <utility>
+#include "simd.h"
+#include "random.h"
 
 namespace util::math{
 	// Linear interpolation by lerpFactor
@@ -17,9 +19,9 @@ namespace util::math{
 		return value < min ? min : value > max ? max : value;
 	}
 
-	// Returns a random number between min and max
+	// Returns a random number in [min, max) from the generator of the calling thread
 	inline float rand_range(float min, float max) noexcept{
-		return lerp(min, max, std::rand() / static_cast<float>(RAND_MAX));
+		return uniform_float(thread_rng(), min, max);
 	}
 
 	// Aligns an integer to the next multiple of the specified alignment
@@ -63,7 +65,8 @@ namespace util::math{
 		constexpr Vec3f cross(const Vec3f other) const noexcept{ return {y * other.z - z * other.y, z * other.x - x * other.z, x * other.y - y * other.x}; }
 	};
 
-	struct Vec4f{
+	//Aligned so that it can be loaded into a single SSE register, the constexpr operators compile to packed instructions as well
+	struct alignas(16) Vec4f{
 		float x = 0.0f, y = 0.0f, z = 0.0f, w = 1.0f;
 
 		constexpr Vec4f operator+(const Vec4f other) const noexcept{ return {x + other.x, y + other.y, z + other.z, w + other.w}; }
@@ -74,5 +77,207 @@ namespace util::math{
 		Vec4f& operator-=(const Vec4f other) noexcept{ return *this = *this - other; }
 		Vec4f& operator*=(const Vec4f other) noexcept{ return *this = *this * other; }
 		Vec4f& operator/=(const Vec4f other) noexcept{ return *this = *this / other; }
+		constexpr float dot(const Vec4f other) const noexcept{ return x * other.x + y * other.y + z * other.z + w * other.w; }
+		constexpr float length_sq() const noexcept{ return dot(*this); }
+		float length() const{ return sqrtf(length_sq()); }
+	};
+
+	// Matrix types, both are column major and transform column vectors, i.e. m * v
+
+	struct Mat3f{
+		Vec3f columns[3] = {{1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}};
+
+		static constexpr Mat3f identity() noexcept{ return {}; }
+		static constexpr Mat3f scaling(const Vec3f s) noexcept{ return {{{s.x, 0.0f, 0.0f}, {0.0f, s.y, 0.0f}, {0.0f, 0.0f, s.z}}}; }
+
+		constexpr Vec3f& operator[](std::size_t column) noexcept{ return columns[column]; }
+		constexpr const Vec3f& operator[](std::size_t column) const noexcept{ return columns[column]; }
+
+		constexpr Vec3f operator*(const Vec3f v) const noexcept{
+			return columns[0] * Vec3f{v.x, v.x, v.x} + columns[1] * Vec3f{v.y, v.y, v.y} + columns[2] * Vec3f{v.z, v.z, v.z};
+		}
+
+		constexpr Mat3f operator*(const Mat3f& other) const noexcept{ return {{*this * other.columns[0], *this * other.columns[1], *this * other.columns[2]}}; }
+		Mat3f& operator*=(const Mat3f& other) noexcept{ return *this = *this * other; }
+
+		constexpr Mat3f transposed() const noexcept{
+			return {{{columns[0].x, columns[1].x, columns[2].x}, {columns[0].y, columns[1].y, columns[2].y}, {columns[0].z, columns[1].z, columns[2].z}}};
+		}
+
+		constexpr float determinant() const noexcept{ return columns[0].dot(columns[1].cross(columns[2])); }
+
+		//The rows of the inverse are the cross products of the columns divided by the determinant, which must not be zero
+		constexpr Mat3f inverse() const noexcept{
+			Vec3f row0 = columns[1].cross(columns[2]);
+			Vec3f row1 = columns[2].cross(columns[0]);
+			Vec3f row2 = columns[0].cross(columns[1]);
+			float invDet = 1.0f / columns[0].dot(row0);
+			Vec3f scale{invDet, invDet, invDet};
+
+			return Mat3f{{row0 * scale, row1 * scale, row2 * scale}}.transposed();
+		}
+	};
+
+	struct alignas(16) Mat4f{
+		Vec4f columns[4] = {{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}};
+
+		static constexpr Mat4f identity() noexcept{ return {}; }
+
+		static constexpr Mat4f translation(const Vec3f t) noexcept{
+			return {{{1.0f, 0.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 1.0f, 0.0f}, {t.x, t.y, t.z, 1.0f}}};
+		}
+
+		static constexpr Mat4f scaling(const Vec3f s) noexcept{
+			return {{{s.x, 0.0f, 0.0f, 0.0f}, {0.0f, s.y, 0.0f, 0.0f}, {0.0f, 0.0f, s.z, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}}};
+		}
+
+		constexpr Vec4f& operator[](std::size_t column) noexcept{ return columns[column]; }
+		constexpr const Vec4f& operator[](std::size_t column) const noexcept{ return columns[column]; }
+
+		Vec4f operator*(const Vec4f v) const noexcept{
+#ifdef UTIL_SSE2
+			__m128 vec = load(v);
+			__m128 result = _mm_mul_ps(load(columns[0]), broadcast<0>(vec));
+
+			result = _mm_add_ps(result, _mm_mul_ps(load(columns[1]), broadcast<1>(vec)));
+			result = _mm_add_ps(result, _mm_mul_ps(load(columns[2]), broadcast<2>(vec)));
+			result = _mm_add_ps(result, _mm_mul_ps(load(columns[3]), broadcast<3>(vec)));
+
+			return store(result);
+#else
+			return columns[0] * Vec4f{v.x, v.x, v.x, v.x} + columns[1] * Vec4f{v.y, v.y, v.y, v.y} +
+				   columns[2] * Vec4f{v.z, v.z, v.z, v.z} + columns[3] * Vec4f{v.w, v.w, v.w, v.w};
+#endif
+		}
+
+		Mat4f operator*(const Mat4f& other) const noexcept{
+			return {{*this * other.columns[0], *this * other.columns[1], *this * other.columns[2], *this * other.columns[3]}};
+		}
+
+		Mat4f& operator*=(const Mat4f& other) noexcept{ return *this = *this * other; }
+
+		//Transforms a position, i.e. w = 1, without dividing by the resulting w
+		Vec3f transform_point(const Vec3f p) const noexcept{
+			Vec4f result = *this * Vec4f{p.x, p.y, p.z, 1.0f};
+
+			return {result.x, result.y, result.z};
+		}
+
+		//Transforms a direction, i.e. w = 0, so translation is ignored
+		Vec3f transform_direction(const Vec3f d) const noexcept{
+			Vec4f result = *this * Vec4f{d.x, d.y, d.z, 0.0f};
+
+			return {result.x, result.y, result.z};
+		}
+
+		Mat4f transposed() const noexcept{
+#ifdef UTIL_SSE2
+			__m128 c0 = load(columns[0]), c1 = load(columns[1]), c2 = load(columns[2]), c3 = load(columns[3]);
+
+			_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+			return {{store(c0), store(c1), store(c2), store(c3)}};
+#else
+			return {{{columns[0].x, columns[1].x, columns[2].x, columns[3].x}, {columns[0].y, columns[1].y, columns[2].y, columns[3].y},
+					 {columns[0].z, columns[1].z, columns[2].z, columns[3].z}, {columns[0].w, columns[1].w, columns[2].w, columns[3].w}}};
+#endif
+		}
+
+		float determinant() const noexcept{
+			const Vec4f* c = columns;
+			float s0 = c[0].x * c[1].y - c[1].x * c[0].y, s1 = c[0].x * c[1].z - c[1].x * c[0].z, s2 = c[0].x * c[1].w - c[1].x * c[0].w;
+			float s3 = c[0].y * c[1].z - c[1].y * c[0].z, s4 = c[0].y * c[1].w - c[1].y * c[0].w, s5 = c[0].z * c[1].w - c[1].z * c[0].w;
+			float t5 = c[2].z * c[3].w - c[3].z * c[2].w, t4 = c[2].y * c[3].w - c[3].y * c[2].w, t3 = c[2].y * c[3].z - c[3].y * c[2].z;
+			float t2 = c[2].x * c[3].w - c[3].x * c[2].w, t1 = c[2].x * c[3].z - c[3].x * c[2].z, t0 = c[2].x * c[3].y - c[3].x * c[2].y;
+
+			return s0 * t5 - s1 * t4 + s2 * t3 + s3 * t2 - s4 * t1 + s5 * t0;
+		}
+
+		/*
+		*	General inverse, the determinant must not be zero.
+		*	Uses the 2x2 block formulation which maps onto SSE registers without any horizontal work except for one sum.
+		*/
+		Mat4f inverse() const noexcept{
+#ifdef UTIL_SSE2
+			//2x2 matrices are stored as (m00, m01, m10, m11) with the columns of this matrix taking the role of rows
+			auto mul = [](__m128 a, __m128 b){
+				return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+								  _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+			};
+			auto adjugateMul = [](__m128 a, __m128 b){ //adj(a) * b
+				return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+								  _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+			};
+			auto mulAdjugate = [](__m128 a, __m128 b){ //a * adj(b)
+				return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+								  _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)), _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+			};
+
+			__m128 c0 = load(columns[0]), c1 = load(columns[1]), c2 = load(columns[2]), c3 = load(columns[3]);
+			__m128 a = _mm_movelh_ps(c0, c1), b = _mm_movehl_ps(c1, c0), c = _mm_movelh_ps(c2, c3), d = _mm_movehl_ps(c3, c2);
+
+			//Determinants of the blocks as (|a|, |b|, |c|, |d|)
+			__m128 blockDet = _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+										 _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)), _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+			__m128 detA = broadcast<0>(blockDet), detB = broadcast<1>(blockDet), detC = broadcast<2>(blockDet), detD = broadcast<3>(blockDet);
+
+			__m128 dc = adjugateMul(d, c);
+			__m128 ab = adjugateMul(a, b);
+			__m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mul(b, dc));
+			__m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mul(c, ab));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mulAdjugate(d, ab));
+			__m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mulAdjugate(a, dc));
+
+			//|m| = |a||d| + |b||c| - tr(adj(a) b adj(d) c)
+			__m128 trace = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+
+			trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(2, 3, 0, 1)));
+			trace = _mm_add_ps(trace, _mm_shuffle_ps(trace, trace, _MM_SHUFFLE(1, 0, 3, 2)));
+
+			__m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+			__m128 invDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+
+			x = _mm_mul_ps(x, invDet);
+			y = _mm_mul_ps(y, invDet);
+			z = _mm_mul_ps(z, invDet);
+			w = _mm_mul_ps(w, invDet);
+
+			//Taking the adjugates of the blocks while putting them back together
+			return {{store(_mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3))), store(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2))),
+					 store(_mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3))), store(_mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)))}};
+#else
+			const Vec4f* c = columns;
+			float s0 = c[0].x * c[1].y - c[1].x * c[0].y, s1 = c[0].x * c[1].z - c[1].x * c[0].z, s2 = c[0].x * c[1].w - c[1].x * c[0].w;
+			float s3 = c[0].y * c[1].z - c[1].y * c[0].z, s4 = c[0].y * c[1].w - c[1].y * c[0].w, s5 = c[0].z * c[1].w - c[1].z * c[0].w;
+			float t5 = c[2].z * c[3].w - c[3].z * c[2].w, t4 = c[2].y * c[3].w - c[3].y * c[2].w, t3 = c[2].y * c[3].z - c[3].y * c[2].z;
+			float t2 = c[2].x * c[3].w - c[3].x * c[2].w, t1 = c[2].x * c[3].z - c[3].x * c[2].z, t0 = c[2].x * c[3].y - c[3].x * c[2].y;
+			float invDet = 1.0f / (s0 * t5 - s1 * t4 + s2 * t3 + s3 * t2 - s4 * t1 + s5 * t0);
+
+			return {{{( c[1].y * t5 - c[1].z * t4 + c[1].w * t3) * invDet, (-c[0].y * t5 + c[0].z * t4 - c[0].w * t3) * invDet,
+					  ( c[3].y * s5 - c[3].z * s4 + c[3].w * s3) * invDet, (-c[2].y * s5 + c[2].z * s4 - c[2].w * s3) * invDet},
+					 {(-c[1].x * t5 + c[1].z * t2 - c[1].w * t1) * invDet, ( c[0].x * t5 - c[0].z * t2 + c[0].w * t1) * invDet,
+					  (-c[3].x * s5 + c[3].z * s2 - c[3].w * s1) * invDet, ( c[2].x * s5 - c[2].z * s2 + c[2].w * s1) * invDet},
+					 {( c[1].x * t4 - c[1].y * t2 + c[1].w * t0) * invDet, (-c[0].x * t4 + c[0].y * t2 - c[0].w * t0) * invDet,
+					  ( c[3].x * s4 - c[3].y * s2 + c[3].w * s0) * invDet, (-c[2].x * s4 + c[2].y * s2 - c[2].w * s0) * invDet},
+					 {(-c[1].x * t3 + c[1].y * t1 - c[1].z * t0) * invDet, ( c[0].x * t3 - c[0].y * t1 + c[0].z * t0) * invDet,
+					  (-c[3].x * s3 + c[3].y * s1 - c[3].z * s0) * invDet, ( c[2].x * s3 - c[2].y * s1 + c[2].z * s0) * invDet}}};
+#endif
+		}
+
+	private:
+#ifdef UTIL_SSE2
+		static __m128 load(const Vec4f& v) noexcept{ return _mm_load_ps(&v.x); }
+
+		static Vec4f store(__m128 v) noexcept{
+			Vec4f result;
+
+			_mm_store_ps(&result.x, v);
+
+			return result;
+		}
+
+		template<int I>
+		static __m128 broadcast(__m128 v) noexcept{ return _mm_shuffle_ps(v, v, _MM_SHUFFLE(I, I, I, I)); }
+#endif
 	};
 }
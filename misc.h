@@ -8,12 +8,18 @@
 #endif
 
 #include <ctime>
+#include <atomic>
+#include <chrono>
 #include <cctype>
+#include <limits>
 #include <memory>
 #include <string>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iterator>
 #include <typeinfo>
+#include <algorithm>
 #include <type_traits>
 #include <string_view>
 
@@ -89,17 +95,163 @@ namespace util{
 	}
 #endif
 
+	//Thread-safe version of std::localtime
+	inline std::tm local_time(std::time_t time) noexcept{
+		std::tm result{};
+
+#ifdef _WIN32
+		localtime_s(&result, &time);
+#else
+		localtime_r(&time, &result);
+#endif
+
+		return result;
+	}
+
 	/*
 	*	Wrapper around std::strftime always using the current time
 	*	Formatting options are directly passed down and thus exactly the same
 	*/
 	inline std::string timestamp(std::string_view fmt){
 		char buffer[128];
-		std::time_t rawTime = std::time(nullptr);
-		std::tm* timeInfo = std::localtime(&rawTime);
+		std::tm timeInfo = local_time(std::time(nullptr));
 
-		std::strftime(buffer, std::size(buffer), fmt.data(), timeInfo);
+		std::strftime(buffer, std::size(buffer), fmt.data(), &timeInfo);
 
 		return buffer;
 	}
+
+	/*
+	*	Timestamps for high rates of calls from many threads, e.g. one per log line.
+	*	The strftime part is only formatted once per second and shared between threads, only the fraction of a second is
+	*	written on every call. The current time comes from std::chrono::steady_clock anchored to the system clock at
+	*	construction, so timestamps never go backwards between calls of calibrate(), which follows adjustments of the system clock.
+	*/
+	class TimestampFormatter{
+	public:
+		TimestampFormatter(std::string_view fmt = "%Y-%m-%d %H:%M:%S", int fractionDigits = 3) :
+			fmt{fmt}, fractionDigits{fractionDigits < 0 ? 0 : fractionDigits > 9 ? 9 : fractionDigits}{
+			calibrate();
+		}
+
+		TimestampFormatter(const TimestampFormatter&) = delete;
+		TimestampFormatter& operator=(const TimestampFormatter&) = delete;
+
+		//May be called while other threads call now or format
+		void calibrate() noexcept{
+			std::int64_t system = nanoseconds_since_epoch(std::chrono::system_clock::now());
+			std::int64_t steady = nanoseconds_since_epoch(std::chrono::steady_clock::now());
+
+			offset.store(system - steady, std::memory_order_relaxed);
+		}
+
+		std::chrono::system_clock::time_point now() const noexcept{
+			std::chrono::nanoseconds sinceEpoch{nanoseconds_since_epoch(std::chrono::steady_clock::now()) + offset.load(std::memory_order_relaxed)};
+
+			return std::chrono::system_clock::time_point{std::chrono::duration_cast<std::chrono::system_clock::duration>(sinceEpoch)};
+		}
+
+		/*
+		*	Writes at most size characters of the timestamp to buffer without null terminating it.
+		*	Returns the length of the whole timestamp which may be larger than size.
+		*/
+		std::size_t format(char* buffer, std::size_t size) const noexcept{
+			return format(now(), buffer, size);
+		}
+
+		std::size_t format(std::chrono::system_clock::time_point time, char* buffer, std::size_t size) const noexcept{
+			auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch());
+			auto second = std::chrono::floor<std::chrono::seconds>(sinceEpoch);
+			char text[maxLength];
+			std::size_t length = prefix(second.count(), text);
+
+			if(fractionDigits > 0){
+				auto fraction = static_cast<std::uint32_t>((sinceEpoch - second).count());
+
+				for(int i = fractionDigits; i < 9; ++i)
+					fraction /= 10;
+
+				text[length] = '.';
+
+				for(int i = fractionDigits; i > 0; --i){
+					text[length + static_cast<std::size_t>(i)] = static_cast<char>('0' + fraction % 10);
+					fraction /= 10;
+				}
+
+				length += static_cast<std::size_t>(fractionDigits) + 1;
+			}
+
+			std::memcpy(buffer, text, std::min(length, size));
+
+			return length;
+		}
+
+		std::string str() const{
+			char buffer[maxLength];
+
+			return {buffer, format(buffer, maxLength)};
+		}
+
+	private:
+		static constexpr std::size_t maxPrefixLength = 64;
+		static constexpr std::size_t maxLength = maxPrefixLength + 10;
+		static constexpr std::size_t words = maxPrefixLength / sizeof(std::uint64_t);
+
+		std::string fmt;
+		int fractionDigits;
+		std::atomic<std::int64_t> offset = 0; //Nanoseconds from the epoch of std::chrono::steady_clock to the one of the system clock
+
+		//Prefix of the last second that was formatted, guarded by a sequence lock that is odd while it is written
+		mutable std::atomic<std::uint32_t> sequence = 0;
+		mutable std::atomic<std::int64_t> cachedSecond = std::numeric_limits<std::int64_t>::min();
+		mutable std::atomic<std::uint64_t> cachedLength = 0;
+		mutable std::atomic<std::uint64_t> cachedText[words] = {};
+
+		template<typename TimePoint>
+		static std::int64_t nanoseconds_since_epoch(TimePoint time) noexcept{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+		}
+
+		//Writes the strftime part of the timestamp to text, which needs to be at least maxPrefixLength long
+		std::size_t prefix(std::int64_t second, char* text) const noexcept{
+			std::uint32_t start = sequence.load(std::memory_order_acquire);
+
+			if((start & 1) == 0 && cachedSecond.load(std::memory_order_relaxed) == second){
+				std::uint64_t copy[words];
+				auto length = static_cast<std::size_t>(cachedLength.load(std::memory_order_relaxed));
+
+				for(std::size_t i = 0; i < words; ++i)
+					copy[i] = cachedText[i].load(std::memory_order_relaxed);
+
+				std::atomic_thread_fence(std::memory_order_acquire);
+
+				if(sequence.load(std::memory_order_relaxed) == start){
+					std::memcpy(text, copy, length);
+
+					return length;
+				}
+			}
+
+			std::uint64_t copy[words] = {};
+			std::tm timeInfo = local_time(static_cast<std::time_t>(second));
+			std::size_t length = std::strftime(reinterpret_cast<char*>(copy), maxPrefixLength, fmt.c_str(), &timeInfo); //Zero if it doesn't fit
+
+			std::memcpy(text, copy, length);
+
+			//Only one thread publishes a new second, the others just use what they formatted themselves
+			if((start & 1) == 0 && sequence.compare_exchange_strong(start, start + 1, std::memory_order_acquire)){
+				std::atomic_thread_fence(std::memory_order_release);
+
+				cachedSecond.store(second, std::memory_order_relaxed);
+				cachedLength.store(length, std::memory_order_relaxed);
+
+				for(std::size_t i = 0; i < words; ++i)
+					cachedText[i].store(copy[i], std::memory_order_relaxed);
+
+				sequence.store(start + 2, std::memory_order_release);
+			}
+
+			return length;
+		}
+	};
 }
@@ -0,0 +1,491 @@
+#pragma once
+
+#include <mutex>
+#include <limits>
+#include <random>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "simd.h"
+
+namespace util::math{
+	//Generator used to turn a single seed into the state of the other generators
+	struct SplitMix64{
+		std::uint64_t state;
+
+		explicit constexpr SplitMix64(std::uint64_t seed) noexcept : state{seed}{}
+
+		constexpr std::uint64_t operator()() noexcept{
+			std::uint64_t z = state += 0x9e3779b97f4a7c15;
+
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+
+			return z ^ (z >> 31);
+		}
+	};
+
+	constexpr std::uint64_t rotate_left(std::uint64_t x, int bits) noexcept{
+		return (x << bits) | (x >> (64 - bits));
+	}
+
+	/*
+	*	xoshiro256++ by Blackman and Vigna, fast general purpose generator with 256 bits of state and a period of 2^256 - 1.
+	*	Satisfies UniformRandomBitGenerator so it works with the distributions in <random>.
+	*	jump and long_jump advance by 2^128 and 2^192 steps, use them to split one seed into non-overlapping streams for different threads.
+	*/
+	class Xoshiro256{
+	public:
+		using result_type = std::uint64_t;
+
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return std::numeric_limits<result_type>::max(); }
+
+		explicit constexpr Xoshiro256(std::uint64_t seed = 0) noexcept{
+			this->seed(seed);
+		}
+
+		//Continues from a state returned by state(), which must not be all zero
+		explicit constexpr Xoshiro256(const std::uint64_t (&state)[4]) noexcept{
+			for(int i = 0; i < 4; ++i)
+				s[i] = state[i];
+		}
+
+		constexpr void seed(std::uint64_t seed) noexcept{
+			SplitMix64 mix{seed};
+
+			for(auto& word : s)
+				word = mix();
+		}
+
+		constexpr result_type operator()() noexcept{
+			std::uint64_t result = rotate_left(s[0] + s[3], 23) + s[0];
+			std::uint64_t t = s[1] << 17;
+
+			s[2] ^= s[0];
+			s[3] ^= s[1];
+			s[1] ^= s[2];
+			s[0] ^= s[3];
+			s[2] ^= t;
+			s[3] = rotate_left(s[3], 45);
+
+			return result;
+		}
+
+		//Advances by 2^128 steps
+		constexpr void jump() noexcept{
+			constexpr std::uint64_t polynomial[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+
+			jump(polynomial);
+		}
+
+		//Advances by 2^192 steps
+		constexpr void long_jump() noexcept{
+			constexpr std::uint64_t polynomial[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3, 0x77710069854ee241, 0x39109bb02acbe635};
+
+			jump(polynomial);
+		}
+
+		//Returns a copy of this generator and jumps ahead, so calling it repeatedly gives non-overlapping streams
+		constexpr Xoshiro256 split() noexcept{
+			Xoshiro256 result = *this;
+
+			jump();
+
+			return result;
+		}
+
+		constexpr const std::uint64_t* state() const noexcept{ return s; }
+
+	private:
+		std::uint64_t s[4] = {};
+
+		constexpr void jump(const std::uint64_t (&polynomial)[4]) noexcept{
+			std::uint64_t result[4] = {};
+
+			for(std::uint64_t word : polynomial){
+				for(int bit = 0; bit < 64; ++bit){
+					if(word & (std::uint64_t{1} << bit)){
+						for(int i = 0; i < 4; ++i)
+							result[i] ^= s[i];
+					}
+
+					(*this)();
+				}
+			}
+
+			for(int i = 0; i < 4; ++i)
+				s[i] = result[i];
+		}
+	};
+
+	/*
+	*	PCG32 (XSH RR) by O'Neill, 32 bit output from 64 bits of state.
+	*	Smaller than Xoshiro256 and supports 2^63 independent streams selected at construction.
+	*	advance skips any number of steps in logarithmic time.
+	*/
+	class Pcg32{
+	public:
+		using result_type = std::uint32_t;
+
+		static constexpr result_type min() noexcept{ return 0; }
+		static constexpr result_type max() noexcept{ return std::numeric_limits<result_type>::max(); }
+
+		explicit constexpr Pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0xda3e39cb94b95bdb) noexcept{
+			this->seed(seed, stream);
+		}
+
+		constexpr void seed(std::uint64_t seed, std::uint64_t stream = 0xda3e39cb94b95bdb) noexcept{
+			state = 0;
+			increment = (stream << 1) | 1;
+			(*this)();
+			state += seed;
+			(*this)();
+		}
+
+		constexpr result_type operator()() noexcept{
+			std::uint64_t old = state;
+
+			state = old * multiplier + increment;
+
+			auto xorShifted = static_cast<std::uint32_t>(((old >> 18) ^ old) >> 27);
+			auto rotation = static_cast<std::uint32_t>(old >> 59);
+
+			return (xorShifted >> rotation) | (xorShifted << ((0u - rotation) & 31));
+		}
+
+		//Same as calling the generator steps times
+		constexpr void advance(std::uint64_t steps) noexcept{
+			std::uint64_t accMultiplier = 1, accIncrement = 0;
+			std::uint64_t curMultiplier = multiplier, curIncrement = increment;
+
+			for(; steps > 0; steps >>= 1){
+				if(steps & 1){
+					accMultiplier *= curMultiplier;
+					accIncrement = accIncrement * curMultiplier + curIncrement;
+				}
+
+				curIncrement = (curMultiplier + 1) * curIncrement;
+				curMultiplier *= curMultiplier;
+			}
+
+			state = accMultiplier * state + accIncrement;
+		}
+
+	private:
+		static constexpr std::uint64_t multiplier = 6364136223846793005;
+
+		std::uint64_t state = 0;
+		std::uint64_t increment = 1;
+	};
+
+	//Top 32 bits of the generator output, the high bits are the best ones for all generators here
+	template<typename Generator>
+	constexpr std::uint32_t random_bits32(Generator& gen){
+		static_assert(std::numeric_limits<typename Generator::result_type>::digits >= 32, "Generator must produce at least 32 bits");
+
+		return static_cast<std::uint32_t>(gen() >> (std::numeric_limits<typename Generator::result_type>::digits - 32));
+	}
+
+	/*
+	*	Converts 32 random bits to floats in [min, max) using the top 24 bits.
+	*	Rounding can make (1 - 2^-24) * (max - min) + min equal to max, so results are clamped to the largest float below max.
+	*/
+	struct FloatRange{
+		float scale;
+		float min;
+		float limit;
+
+		FloatRange(float min, float max) noexcept : scale{(max - min) * 0x1p-24f}, min{min}, limit{max > min ? float_below(max) : std::numeric_limits<float>::infinity()}{}
+
+		float operator()(std::uint32_t bits) const noexcept{ return std::min(static_cast<float>(bits >> 8) * scale + min, limit); }
+
+		//Largest float below a number that isn't NaN or negative infinity
+		static float float_below(float value) noexcept{
+			std::uint32_t bits;
+
+			if(value == 0.0f)
+				return -std::numeric_limits<float>::denorm_min();
+
+			std::memcpy(&bits, &value, sizeof(bits));
+			bits = value > 0.0f ? bits - 1 : bits + 1;
+			std::memcpy(&value, &bits, sizeof(bits));
+
+			return value;
+		}
+	};
+
+	inline float bits_to_float(std::uint32_t bits, float min, float max) noexcept{
+		return FloatRange{min, max}(bits);
+	}
+
+	//Uniformly distributed float in [min, max), see FloatRange
+	template<typename Generator>
+	float uniform_float(Generator& gen, float min, float max){
+		return bits_to_float(random_bits32(gen), min, max);
+	}
+
+	//Uniformly distributed integer in [min, max] without bias, integers larger than 32 bits aren't supported
+	template<typename T, typename Generator>
+	constexpr T uniform_int(Generator& gen, T min, T max){
+		static_assert(std::is_integral_v<T> && sizeof(T) <= 4, "uniform_int supports integers up to 32 bits");
+
+		auto range = static_cast<std::uint32_t>(static_cast<std::uint32_t>(max) - static_cast<std::uint32_t>(min) + 1);
+
+		if(range == 0) //Full 32 bit range
+			return static_cast<T>(random_bits32(gen));
+
+		//Lemire's multiply and shift, rejecting the few values that would make some results more likely
+		std::uint64_t product = std::uint64_t{random_bits32(gen)} * range;
+
+		if(static_cast<std::uint32_t>(product) < range){
+			std::uint32_t threshold = (0u - range) % range;
+
+			while(static_cast<std::uint32_t>(product) < threshold)
+				product = std::uint64_t{random_bits32(gen)} * range;
+		}
+
+		return static_cast<T>(static_cast<std::uint32_t>(min) + static_cast<std::uint32_t>(product >> 32));
+	}
+
+	/*
+	*	Four interleaved Xoshiro256 streams, each one jump apart, for filling large arrays.
+	*	The streams are advanced together so they map directly onto AVX2 registers, every step yields eight 32 bit words.
+	*	The generated words are the same with and without AVX2.
+	*/
+	class Xoshiro256x4{
+	public:
+		explicit Xoshiro256x4(std::uint64_t seed = 0) noexcept : Xoshiro256x4{Xoshiro256{seed}}{}
+
+		explicit Xoshiro256x4(Xoshiro256 gen) noexcept{
+			for(int lane = 0; lane < 4; ++lane){
+				for(int i = 0; i < 4; ++i)
+					s[i][lane] = gen.state()[i];
+
+				gen.jump();
+			}
+		}
+
+		void fill(std::uint32_t* out, std::size_t count) noexcept{
+			std::size_t i = 0;
+#ifdef UTIL_AVX2_DISPATCH
+			if(simd::has_avx2())
+				i = fill_bits_avx2(s, out, count);
+#endif
+			fill_scalar(out + i, count - i, [](std::uint32_t bits){ return bits; });
+		}
+
+		//Floats in [min, max), see FloatRange
+		void fill(float* out, std::size_t count, float min, float max) noexcept{
+			FloatRange range{min, max};
+			std::size_t i = 0;
+#ifdef UTIL_AVX2_DISPATCH
+			if(simd::has_avx2())
+				i = fill_float_avx2(s, out, count, range);
+#endif
+			fill_scalar(out + i, count - i, range);
+		}
+
+		//Integers in [min, max], the bias towards some values is at most (max - min + 1) / 2^32, use uniform_int where that matters
+		void fill(std::int32_t* out, std::size_t count, std::int32_t min, std::int32_t max) noexcept{
+			auto range = static_cast<std::uint32_t>(static_cast<std::uint32_t>(max) - static_cast<std::uint32_t>(min) + 1);
+
+			if(range == 0){
+				fill(reinterpret_cast<std::uint32_t*>(out), count);
+
+				return;
+			}
+
+			std::size_t i = 0;
+#ifdef UTIL_AVX2_DISPATCH
+			if(simd::has_avx2())
+				i = fill_int_avx2(s, out, count, min, range);
+#endif
+			fill_scalar(out + i, count - i, [=](std::uint32_t bits){ return scale_int(bits, min, range); });
+		}
+
+	private:
+		using State = std::uint64_t[4][4];
+
+		alignas(32) State s; //s[i][lane] is word i of the state of stream lane
+
+		static constexpr std::int32_t scale_int(std::uint32_t bits, std::int32_t min, std::uint32_t range) noexcept{
+			return static_cast<std::int32_t>(static_cast<std::uint32_t>(min) + static_cast<std::uint32_t>((std::uint64_t{bits} * range) >> 32));
+		}
+
+		//Low and high half of the output of every stream in order
+		void next(std::uint32_t (&words)[8]) noexcept{
+			for(int lane = 0; lane < 4; ++lane){
+				std::uint64_t result = rotate_left(s[0][lane] + s[3][lane], 23) + s[0][lane];
+				std::uint64_t t = s[1][lane] << 17;
+
+				s[2][lane] ^= s[0][lane];
+				s[3][lane] ^= s[1][lane];
+				s[1][lane] ^= s[2][lane];
+				s[0][lane] ^= s[3][lane];
+				s[2][lane] ^= t;
+				s[3][lane] = rotate_left(s[3][lane], 45);
+
+				words[lane * 2] = static_cast<std::uint32_t>(result);
+				words[lane * 2 + 1] = static_cast<std::uint32_t>(result >> 32);
+			}
+		}
+
+		template<typename T, typename Convert>
+		void fill_scalar(T* out, std::size_t count, Convert convert) noexcept{
+			std::uint32_t words[8];
+
+			for(std::size_t i = 0; i < count; i += 8){
+				next(words);
+
+				for(std::size_t j = 0; j < 8 && i + j < count; ++j)
+					out[i + j] = convert(words[j]);
+			}
+		}
+
+#ifdef UTIL_AVX2_DISPATCH
+		UTIL_TARGET_AVX2 static __m256i rotate_left_avx2(__m256i x, int bits) noexcept{
+			return _mm256_or_si256(_mm256_slli_epi64(x, bits), _mm256_srli_epi64(x, 64 - bits));
+		}
+
+		UTIL_TARGET_AVX2 static __m256i next_avx2(__m256i (&v)[4]) noexcept{
+			__m256i result = _mm256_add_epi64(rotate_left_avx2(_mm256_add_epi64(v[0], v[3]), 23), v[0]);
+			__m256i t = _mm256_slli_epi64(v[1], 17);
+
+			v[2] = _mm256_xor_si256(v[2], v[0]);
+			v[3] = _mm256_xor_si256(v[3], v[1]);
+			v[1] = _mm256_xor_si256(v[1], v[2]);
+			v[0] = _mm256_xor_si256(v[0], v[3]);
+			v[2] = _mm256_xor_si256(v[2], t);
+			v[3] = rotate_left_avx2(v[3], 45);
+
+			return result;
+		}
+
+		/*
+		*	The AVX2 versions process whole steps of eight words and return how many outputs they wrote.
+		*	The state is loaded once and written back at the end.
+		*/
+
+		template<typename T, typename Convert>
+		UTIL_TARGET_AVX2 static std::size_t fill_avx2(State& s, T* out, std::size_t count, Convert convert) noexcept{
+			__m256i v[4];
+
+			for(int i = 0; i < 4; ++i)
+				v[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(s[i]));
+
+			std::size_t i = 0;
+
+			for(; i + 8 <= count; i += 8)
+				convert(next_avx2(v), out + i);
+
+			for(int j = 0; j < 4; ++j)
+				_mm256_store_si256(reinterpret_cast<__m256i*>(s[j]), v[j]);
+
+			return i;
+		}
+
+		UTIL_TARGET_AVX2 static std::size_t fill_bits_avx2(State& s, std::uint32_t* out, std::size_t count) noexcept{
+			return fill_avx2(s, out, count, BitsConverter{});
+		}
+
+		UTIL_TARGET_AVX2 static std::size_t fill_float_avx2(State& s, float* out, std::size_t count, const FloatRange& range) noexcept{
+			return fill_avx2(s, out, count, FloatConverter{_mm256_set1_ps(range.scale), _mm256_set1_ps(range.min), _mm256_set1_ps(range.limit)});
+		}
+
+		UTIL_TARGET_AVX2 static std::size_t fill_int_avx2(State& s, std::int32_t* out, std::size_t count, std::int32_t min, std::uint32_t range) noexcept{
+			return fill_avx2(s, out, count, IntConverter{_mm256_set1_epi64x(range), _mm256_set1_epi32(min)});
+		}
+
+		struct BitsConverter{
+			UTIL_TARGET_AVX2 void operator()(__m256i bits, std::uint32_t* out) const noexcept{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), bits);
+			}
+		};
+
+		struct FloatConverter{
+			__m256 scale;
+			__m256 offset;
+			__m256 limit;
+
+			UTIL_TARGET_AVX2 void operator()(__m256i bits, float* out) const noexcept{
+				__m256 value = _mm256_cvtepi32_ps(_mm256_srli_epi32(bits, 8));
+
+				_mm256_storeu_ps(out, _mm256_min_ps(_mm256_add_ps(_mm256_mul_ps(value, scale), offset), limit));
+			}
+		};
+
+		struct IntConverter{
+			__m256i range;
+			__m256i offset;
+
+			//High halves of the 32x32 bit products for the low and high word of every 64 bit lane
+			UTIL_TARGET_AVX2 void operator()(__m256i bits, std::int32_t* out) const noexcept{
+				__m256i low = _mm256_srli_epi64(_mm256_mul_epu32(bits, range), 32);
+				__m256i high = _mm256_mul_epu32(_mm256_srli_epi64(bits, 32), range);
+
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi32(_mm256_blend_epi32(low, high, 0xAA), offset));
+			}
+		};
+#endif
+	};
+
+	//Generators of one thread, the lanes of bulk start one to four jumps after single so that none of them overlap
+	struct ThreadRng{
+		Xoshiro256 single;
+		Xoshiro256x4 bulk;
+
+		explicit ThreadRng(std::uint64_t seed) noexcept : ThreadRng{Xoshiro256{seed}}{}
+		explicit ThreadRng(const Xoshiro256& gen) noexcept : single{gen}, bulk{jumped(gen)}{}
+
+		static Xoshiro256 jumped(Xoshiro256 gen) noexcept{
+			gen.jump();
+
+			return gen;
+		}
+	};
+
+	//Threads take turns a long jump apart in the sequence of one randomly seeded generator, so their streams never overlap
+	inline Xoshiro256 next_thread_stream() noexcept{
+		static std::mutex mutex;
+		static Xoshiro256 base{(std::uint64_t{std::random_device{}()} << 32) ^ std::random_device{}()};
+		std::lock_guard<std::mutex> lock{mutex};
+		Xoshiro256 result = base;
+
+		base.long_jump();
+
+		return result;
+	}
+
+	inline ThreadRng& thread_rng_state() noexcept{
+		thread_local ThreadRng rng{next_thread_stream()};
+
+		return rng;
+	}
+
+	//Generator owned by the calling thread, so no locking is needed
+	inline Xoshiro256& thread_rng() noexcept{ return thread_rng_state().single; }
+
+	//Bulk generator owned by the calling thread, independent of thread_rng
+	inline Xoshiro256x4& thread_bulk_rng() noexcept{ return thread_rng_state().bulk; }
+
+	/*
+	*	Reseeds the generators of the calling thread, the same seed always gives the same sequence.
+	*	For reproducible parallel runs give every thread its own seed, e.g. a base seed plus the index of the thread.
+	*/
+	inline void seed_thread_rng(std::uint64_t seed) noexcept{
+		thread_rng_state() = ThreadRng{seed};
+	}
+
+	//Fills out with uniformly distributed floats in [min, max) from the generator of the calling thread
+	inline void fill_uniform(float* out, std::size_t count, float min, float max) noexcept{
+		thread_bulk_rng().fill(out, count, min, max);
+	}
+
+	//Fills out with integers in [min, max] from the generator of the calling thread, see Xoshiro256x4::fill
+	inline void fill_uniform(std::int32_t* out, std::size_t count, std::int32_t min, std::int32_t max) noexcept{
+		thread_bulk_rng().fill(out, count, min, max);
+	}
+}
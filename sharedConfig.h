@@ -0,0 +1,253 @@
+#pragma once
+
+#ifdef __linux__
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <filesystem>
+#include "config.h"
+#include "stringUtil.h"
+
+namespace util{
+	/*
+	*	Config that can be shared between threads.
+	*	Readers get an immutable snapshot which stays alive for as long as they hold on to it,
+	*	writers copy the current version, change the copy and publish it as the new version.
+	*	Readers never wait for copying or parsing, only for the pointer swap itself (std::atomic<std::shared_ptr> where available).
+	*	Typed reads on a snapshot fill its cache, so later reads of the same value don't convert anything.
+	*	Handles are only valid for the snapshot they were obtained from.
+	*/
+	class SharedConfig{
+	public:
+		using Snapshot = std::shared_ptr<const Config>;
+
+		SharedConfig() : SharedConfig{Config{}}{}
+		SharedConfig(Config config) : current{std::make_shared<const Version>(Version{std::move(config), 0})}{}
+
+		SharedConfig(const SharedConfig&) = delete;
+		SharedConfig& operator=(const SharedConfig&) = delete;
+
+		Snapshot snapshot() const noexcept{
+			std::shared_ptr<const Version> version = load();
+
+			return Snapshot{version, &version->config};
+		}
+
+		//Snapshot together with the version number it was published as
+		Snapshot snapshot(std::uint64_t& versionNumber) const noexcept{
+			std::shared_ptr<const Version> version = load();
+
+			versionNumber = version->number;
+
+			return Snapshot{version, &version->config};
+		}
+
+		std::uint64_t version() const noexcept{ return load()->number; }
+
+		//Replaces the current version
+		void publish(Config config){
+			std::lock_guard<std::mutex> lock{writeMutex};
+
+			store(std::move(config));
+		}
+
+		//Applies func to a copy of the current version and publishes the result, concurrent writers are serialized
+		template<typename Func>
+		void update(Func&& func){
+			std::lock_guard<std::mutex> lock{writeMutex};
+			Config next = load()->config;
+
+			func(next);
+			store(std::move(next));
+		}
+
+	private:
+		//The number is published with the config so a reader never sees one without the other
+		struct Version{
+			Config config;
+			std::uint64_t number;
+		};
+
+#if __cpp_lib_atomic_shared_ptr
+		std::atomic<std::shared_ptr<const Version>> current;
+#else
+		std::shared_ptr<const Version> current; //Only accessed through the atomic free functions
+#endif
+		std::mutex writeMutex;
+
+		std::shared_ptr<const Version> load() const noexcept{
+#if __cpp_lib_atomic_shared_ptr
+			return current.load(std::memory_order_acquire);
+#else
+			return std::atomic_load_explicit(&current, std::memory_order_acquire);
+#endif
+		}
+
+		//Must be called with writeMutex locked
+		void store(Config config){
+			auto next = std::make_shared<const Version>(Version{std::move(config), load()->number + 1});
+
+#if __cpp_lib_atomic_shared_ptr
+			current.store(std::move(next), std::memory_order_release);
+#else
+			std::atomic_store_explicit(&current, std::move(next), std::memory_order_release);
+#endif
+		}
+	};
+
+	/*
+	*	Watches the files a SharedConfig was loaded from and publishes a freshly parsed version whenever one of them changes.
+	*	Files are loaded in order so later ones override earlier ones, just like successive calls to load_from_file.
+	*	Uses inotify on Linux and compares modification times every pollInterval elsewhere.
+	*	pollInterval is also how long stop() may wait for the watching thread and must be positive.
+	*/
+	class ConfigReloader{
+	public:
+		ConfigReloader(SharedConfig& config, std::vector<std::string> fileNames, std::chrono::milliseconds pollInterval = std::chrono::milliseconds{250}) :
+			config{config}, fileNames{std::move(fileNames)}, pollInterval{pollInterval}{
+			if(pollInterval <= std::chrono::milliseconds::zero())
+				throw std::invalid_argument{"ConfigReloader::ConfigReloader: Poll interval must be positive"}; //Zero would make the watching thread spin
+
+			for(const std::string& fileName : this->fileNames)
+				modificationTimes.push_back(modification_time(fileName));
+
+			watchThread = std::thread{&ConfigReloader::watch, this};
+		}
+
+		ConfigReloader(const ConfigReloader&) = delete;
+		ConfigReloader& operator=(const ConfigReloader&) = delete;
+
+		~ConfigReloader(){
+			stop();
+		}
+
+		//Parses all files and publishes the result, the current version is kept if any of them can't be read
+		bool reload(){
+			Config next;
+
+			for(const std::string& fileName : fileNames){
+				//Not using a mapped file since the snapshot would change with the file
+				if(!next.load_from_file(fileName, false))
+					return false;
+			}
+
+			config.publish(std::move(next));
+
+			return true;
+		}
+
+		void stop(){
+			running = false;
+
+			if(watchThread.joinable())
+				watchThread.join();
+		}
+
+	private:
+		SharedConfig& config;
+		std::vector<std::string> fileNames;
+		std::vector<std::filesystem::file_time_type> modificationTimes;
+		std::chrono::milliseconds pollInterval;
+		std::atomic<bool> running = true;
+		std::thread watchThread;
+
+		static std::filesystem::file_time_type modification_time(const std::string& fileName){
+			std::error_code error;
+			auto time = std::filesystem::last_write_time(fileName, error);
+
+			return error ? std::filesystem::file_time_type{} : time;
+		}
+
+		bool modification_times_changed(){
+			bool changed = false;
+
+			for(std::size_t i = 0; i < fileNames.size(); ++i){
+				auto time = modification_time(fileNames[i]);
+
+				if(time != modificationTimes[i]){
+					modificationTimes[i] = time;
+					changed = true;
+				}
+			}
+
+			return changed;
+		}
+
+#ifdef __linux__
+		void watch(){
+			int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+			if(fd == -1){
+				poll_modification_times();
+
+				return;
+			}
+
+			//Watching the directories rather than the files themselves so that files replaced by a rename are noticed as well
+			std::vector<std::pair<int, std::string>> watches;
+
+			for(const std::string& fileName : fileNames){
+				std::string directory = str::path(fileName);
+				int wd = inotify_add_watch(fd, directory.empty() ? "." : directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+
+				if(wd != -1)
+					watches.emplace_back(wd, str::file_name(fileName));
+			}
+
+			while(running){
+				pollfd pfd{fd, POLLIN, 0};
+
+				if(::poll(&pfd, 1, static_cast<int>(pollInterval.count())) <= 0)
+					continue;
+
+				alignas(inotify_event) char buffer[4096];
+				bool changed = false;
+				ssize_t length;
+
+				while((length = read(fd, buffer, sizeof(buffer))) > 0){
+					for(ssize_t i = 0; i < length;){
+						const auto* event = reinterpret_cast<const inotify_event*>(buffer + i);
+
+						for(const auto& watch : watches){
+							if(event->wd == watch.first && event->len > 0 && watch.second == event->name)
+								changed = true;
+						}
+
+						i += sizeof(inotify_event) + event->len;
+					}
+				}
+
+				if(changed)
+					reload();
+			}
+
+			close(fd);
+		}
+#else
+		void watch(){
+			poll_modification_times();
+		}
+#endif
+
+		void poll_modification_times(){
+			while(running){
+				std::this_thread::sleep_for(pollInterval);
+
+				if(modification_times_changed())
+					reload();
+			}
+		}
+	};
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+
+//Instruction sets that are enabled at compile time, everything using them needs a scalar fallback
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define UTIL_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define UTIL_AVX2 1
+#include <immintrin.h>
+#endif
+
+//Functions marked with UTIL_TARGET_AVX2 may use AVX2 even if it isn't enabled, callers need to check simd::has_avx2 first
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define UTIL_AVX2_DISPATCH 1
+#define UTIL_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define UTIL_AVX2_DISPATCH 1
+#define UTIL_TARGET_AVX2
+#include <immintrin.h>
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace util::simd{
+	//Whether the CPU the program is running on supports AVX2, only checked once
+	inline bool has_avx2() noexcept{
+#if defined(UTIL_AVX2)
+		return true;
+#elif defined(UTIL_AVX2_DISPATCH) && defined(__GNUC__)
+		static const bool supported = __builtin_cpu_supports("avx2");
+
+		return supported;
+#elif defined(UTIL_AVX2_DISPATCH) && defined(_MSC_VER)
+		static const bool supported = []{
+			int info[4];
+
+			__cpuid(info, 0);
+
+			if(info[0] < 7)
+				return false;
+
+			__cpuid(info, 1);
+
+			constexpr int osxsave = 1 << 27, avx = 1 << 28;
+
+			if((info[2] & (osxsave | avx)) != (osxsave | avx) || (_xgetbv(0) & 6) != 6) //The OS also needs to preserve the YMM registers
+				return false;
+
+			__cpuidex(info, 7, 0);
+
+			return (info[1] & (1 << 5)) != 0;
+		}();
+
+		return supported;
+#else
+		return false;
+#endif
+	}
+
+	//Index of the lowest set bit, mask must not be zero
+	inline unsigned count_trailing_zeros(std::uint32_t mask) noexcept{
+#ifdef _MSC_VER
+		unsigned long index;
+
+		_BitScanForward(&index, mask);
+
+		return static_cast<unsigned>(index);
+#else
+		return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+	}
+}
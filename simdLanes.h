@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include "simd.h"
+
+/*
+*	Lane types that batched float kernels are written against, so the same template works for scalars, SSE2 and AVX2.
+*	Masks returned by less have all bits of a lane set where the comparison is true.
+*	The *_int functions treat the bits of every lane as a 32 bit integer.
+*/
+
+namespace util::simd{
+	struct ScalarLane{
+		using Type = float;
+
+		static constexpr std::size_t width = 1;
+
+		static Type load(const float* p) noexcept{ return *p; }
+		static void store(float* p, Type v) noexcept{ *p = v; }
+		static Type set(float v) noexcept{ return v; }
+		static Type set_bits(std::uint32_t v) noexcept{ return from_bits(v); }
+		static Type add(Type a, Type b) noexcept{ return a + b; }
+		static Type sub(Type a, Type b) noexcept{ return a - b; }
+		static Type mul(Type a, Type b) noexcept{ return a * b; }
+		static Type div(Type a, Type b) noexcept{ return a / b; }
+		static Type min(Type a, Type b) noexcept{ return b < a ? b : a; }
+		static Type max(Type a, Type b) noexcept{ return a < b ? b : a; }
+		static Type sqrt(Type a) noexcept{ return std::sqrt(a); }
+
+		//Estimate of 1 / sqrt(a) with a relative error below 1.5 * 2^-12, or 2e-3 without SSE
+		static Type rsqrt(Type a) noexcept{
+#ifdef UTIL_SSE2
+			return _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(a)));
+#else
+			Type estimate = from_bits(0x5f375a86 - (bits(a) >> 1));
+
+			return estimate * (1.5f - 0.5f * a * estimate * estimate);
+#endif
+		}
+
+		static Type bit_and(Type a, Type b) noexcept{ return from_bits(bits(a) & bits(b)); }
+		static Type bit_or(Type a, Type b) noexcept{ return from_bits(bits(a) | bits(b)); }
+		static Type bit_xor(Type a, Type b) noexcept{ return from_bits(bits(a) ^ bits(b)); }
+		static Type bit_andnot(Type a, Type b) noexcept{ return from_bits(~bits(a) & bits(b)); } //~a & b
+		static Type less(Type a, Type b) noexcept{ return from_bits(a < b ? ~std::uint32_t{0} : 0); }
+		static Type select(Type mask, Type a, Type b) noexcept{ return bits(mask) ? a : b; } //a where mask is set, b otherwise
+		static Type add_int(Type a, Type b) noexcept{ return from_bits(bits(a) + bits(b)); }
+
+		template<int Bits>
+		static Type shift_left_int(Type a) noexcept{ return from_bits(bits(a) << Bits); }
+
+		//Arithmetic shift, fills with the sign bit
+		template<int Bits>
+		static Type shift_right_int(Type a) noexcept{
+			std::uint32_t value = bits(a);
+
+			return from_bits((value >> Bits) | (value & 0x80000000u ? ~(~std::uint32_t{0} >> Bits) : 0));
+		}
+
+		static std::uint32_t bits(Type a) noexcept{
+			std::uint32_t result;
+
+			std::memcpy(&result, &a, sizeof(result));
+
+			return result;
+		}
+
+		static Type from_bits(std::uint32_t a) noexcept{
+			Type result;
+
+			std::memcpy(&result, &a, sizeof(result));
+
+			return result;
+		}
+	};
+
+#ifdef UTIL_SSE2
+	struct Sse2Lane{
+		using Type = __m128;
+
+		static constexpr std::size_t width = 4;
+
+		static Type load(const float* p) noexcept{ return _mm_loadu_ps(p); }
+		static void store(float* p, Type v) noexcept{ _mm_storeu_ps(p, v); }
+		static Type set(float v) noexcept{ return _mm_set1_ps(v); }
+		static Type set_bits(std::uint32_t v) noexcept{ return _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(v))); }
+		static Type add(Type a, Type b) noexcept{ return _mm_add_ps(a, b); }
+		static Type sub(Type a, Type b) noexcept{ return _mm_sub_ps(a, b); }
+		static Type mul(Type a, Type b) noexcept{ return _mm_mul_ps(a, b); }
+		static Type div(Type a, Type b) noexcept{ return _mm_div_ps(a, b); }
+		static Type min(Type a, Type b) noexcept{ return _mm_min_ps(a, b); }
+		static Type max(Type a, Type b) noexcept{ return _mm_max_ps(a, b); }
+		static Type sqrt(Type a) noexcept{ return _mm_sqrt_ps(a); }
+		static Type rsqrt(Type a) noexcept{ return _mm_rsqrt_ps(a); }
+		static Type bit_and(Type a, Type b) noexcept{ return _mm_and_ps(a, b); }
+		static Type bit_or(Type a, Type b) noexcept{ return _mm_or_ps(a, b); }
+		static Type bit_xor(Type a, Type b) noexcept{ return _mm_xor_ps(a, b); }
+		static Type bit_andnot(Type a, Type b) noexcept{ return _mm_andnot_ps(a, b); }
+		static Type less(Type a, Type b) noexcept{ return _mm_cmplt_ps(a, b); }
+		static Type select(Type mask, Type a, Type b) noexcept{ return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+		static Type add_int(Type a, Type b) noexcept{ return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(a), _mm_castps_si128(b))); }
+
+		template<int Bits>
+		static Type shift_left_int(Type a) noexcept{ return _mm_castsi128_ps(_mm_slli_epi32(_mm_castps_si128(a), Bits)); }
+
+		template<int Bits>
+		static Type shift_right_int(Type a) noexcept{ return _mm_castsi128_ps(_mm_srai_epi32(_mm_castps_si128(a), Bits)); }
+	};
+#endif
+
+#ifdef UTIL_AVX2_DISPATCH
+	struct Avx2Lane{
+		using Type = __m256;
+
+		static constexpr std::size_t width = 8;
+
+		UTIL_TARGET_AVX2 static Type load(const float* p) noexcept{ return _mm256_loadu_ps(p); }
+		UTIL_TARGET_AVX2 static void store(float* p, Type v) noexcept{ _mm256_storeu_ps(p, v); }
+		UTIL_TARGET_AVX2 static Type set(float v) noexcept{ return _mm256_set1_ps(v); }
+		UTIL_TARGET_AVX2 static Type set_bits(std::uint32_t v) noexcept{ return _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(v))); }
+		UTIL_TARGET_AVX2 static Type add(Type a, Type b) noexcept{ return _mm256_add_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type sub(Type a, Type b) noexcept{ return _mm256_sub_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type mul(Type a, Type b) noexcept{ return _mm256_mul_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type div(Type a, Type b) noexcept{ return _mm256_div_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type min(Type a, Type b) noexcept{ return _mm256_min_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type max(Type a, Type b) noexcept{ return _mm256_max_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type sqrt(Type a) noexcept{ return _mm256_sqrt_ps(a); }
+		UTIL_TARGET_AVX2 static Type rsqrt(Type a) noexcept{ return _mm256_rsqrt_ps(a); }
+		UTIL_TARGET_AVX2 static Type bit_and(Type a, Type b) noexcept{ return _mm256_and_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type bit_or(Type a, Type b) noexcept{ return _mm256_or_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type bit_xor(Type a, Type b) noexcept{ return _mm256_xor_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type bit_andnot(Type a, Type b) noexcept{ return _mm256_andnot_ps(a, b); }
+		UTIL_TARGET_AVX2 static Type less(Type a, Type b) noexcept{ return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		UTIL_TARGET_AVX2 static Type select(Type mask, Type a, Type b) noexcept{ return _mm256_blendv_ps(b, a, mask); }
+		UTIL_TARGET_AVX2 static Type add_int(Type a, Type b) noexcept{ return _mm256_castsi256_ps(_mm256_add_epi32(_mm256_castps_si256(a), _mm256_castps_si256(b))); }
+
+		template<int Bits>
+		UTIL_TARGET_AVX2 static Type shift_left_int(Type a) noexcept{ return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_castps_si256(a), Bits)); }
+
+		template<int Bits>
+		UTIL_TARGET_AVX2 static Type shift_right_int(Type a) noexcept{ return _mm256_castsi256_ps(_mm256_srai_epi32(_mm256_castps_si256(a), Bits)); }
+	};
+#endif
+}
@@ -0,0 +1,692 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <exception>
+#include <algorithm>
+#include <stdexcept>
+#include "mathUtil.h"
+
+namespace util::math{
+	inline float component(const Vec3f& v, int axis) noexcept{ return axis == 0 ? v.x : axis == 1 ? v.y : v.z; }
+
+	//Axis aligned bounding box, a default constructed box is empty and can be grown with extend
+	struct AABB{
+		Vec3f min{std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity()};
+		Vec3f max{-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity()};
+
+		AABB() = default;
+		constexpr AABB(const Vec3f minimum, const Vec3f maximum) noexcept : min{minimum}, max{maximum}{}
+
+		bool empty() const noexcept{ return min.x > max.x || min.y > max.y || min.z > max.z; }
+
+		void extend(const Vec3f p) noexcept{
+			min = {std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z)};
+			max = {std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z)};
+		}
+
+		void extend(const AABB& other) noexcept{
+			min = {std::min(min.x, other.min.x), std::min(min.y, other.min.y), std::min(min.z, other.min.z)};
+			max = {std::max(max.x, other.max.x), std::max(max.y, other.max.y), std::max(max.z, other.max.z)};
+		}
+
+		Vec3f center() const noexcept{ return min * Vec3f{0.5f, 0.5f, 0.5f} + max * Vec3f{0.5f, 0.5f, 0.5f}; } //Halving first can't overflow
+		Vec3f extent() const noexcept{ return max - min; }
+
+		//Zero for empty boxes
+		float surface_area() const noexcept{
+			if(empty())
+				return 0.0f;
+
+			Vec3f e = extent();
+
+			return 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+		}
+
+		int longest_axis() const noexcept{
+			Vec3f e = extent();
+
+			return e.x >= e.y && e.x >= e.z ? 0 : e.y >= e.z ? 1 : 2;
+		}
+
+		bool contains(const Vec3f p) const noexcept{
+			return p.x >= min.x && p.x <= max.x && p.y >= min.y && p.y <= max.y && p.z >= min.z && p.z <= max.z;
+		}
+
+		bool overlaps(const AABB& other) const noexcept{
+			return min.x <= other.max.x && max.x >= other.min.x && min.y <= other.max.y && max.y >= other.min.y && min.z <= other.max.z && max.z >= other.min.z;
+		}
+	};
+
+	struct Ray{
+		Vec3f origin;
+		Vec3f direction;
+	};
+
+	struct RayHit{
+		static constexpr std::uint32_t none = std::numeric_limits<std::uint32_t>::max();
+
+		std::uint32_t primitive = none;
+		float distance = std::numeric_limits<float>::infinity();
+
+		bool hit() const noexcept{ return primitive != none; }
+	};
+
+	//Result of a batched query, the indices found for query i are indices[offsets[i]] to indices[offsets[i + 1]]
+	struct IndexLists{
+		std::vector<std::size_t> offsets;
+		std::vector<std::uint32_t> indices;
+
+		std::size_t size() const noexcept{ return offsets.empty() ? 0 : offsets.size() - 1; }
+		const std::uint32_t* begin(std::size_t query) const noexcept{ return indices.data() + offsets[query]; }
+		const std::uint32_t* end(std::size_t query) const noexcept{ return indices.data() + offsets[query + 1]; }
+	};
+
+	//Splits [0, count) into one contiguous chunk per thread and calls func(begin, end) for each chunk, threads = 0 uses all cores
+	template<typename Func>
+	void parallel_chunks(std::size_t count, unsigned threads, Func&& func){
+		if(threads == 0)
+			threads = std::max(1u, std::thread::hardware_concurrency());
+
+		std::size_t chunks = std::max<std::size_t>(1, std::min<std::size_t>(threads, count));
+		std::vector<std::thread> workers;
+
+		workers.reserve(chunks - 1);
+
+		for(std::size_t chunk = 1; chunk < chunks; ++chunk)
+			workers.emplace_back([&func, count, chunks, chunk]{ func(count * chunk / chunks, count * (chunk + 1) / chunks); });
+
+		func(0, count / chunks);
+
+		for(auto& worker : workers)
+			worker.join();
+	}
+
+	//Runs find(query, output) for every query in parallel and concatenates the outputs in query order
+	template<typename Find>
+	IndexLists collect_parallel(std::size_t count, unsigned threads, Find&& find){
+		std::vector<std::vector<std::uint32_t>> results(count);
+
+		parallel_chunks(count, threads, [&](std::size_t begin, std::size_t end){
+			for(std::size_t i = begin; i < end; ++i)
+				find(i, results[i]);
+		});
+
+		IndexLists lists;
+
+		lists.offsets.resize(count + 1);
+		lists.offsets[0] = 0;
+
+		for(std::size_t i = 0; i < count; ++i)
+			lists.offsets[i + 1] = lists.offsets[i] + results[i].size();
+
+		lists.indices.reserve(lists.offsets[count]);
+
+		for(const auto& result : results)
+			lists.indices.insert(lists.indices.end(), result.begin(), result.end());
+
+		return lists;
+	}
+
+	struct BvhOptions{
+		std::uint32_t maxLeafSize = 4;
+		unsigned threads = 0;                //Zero uses all cores
+		std::size_t parallelThreshold = 8192; //Subtrees with fewer primitives are built by the thread that reached them
+	};
+
+	/*
+	*	Bounding volume hierarchy over boxes, built with a binned surface area heuristic.
+	*	The nodes are stored in one array with the two children of a node next to each other.
+	*	Primitives are referred to by their index in the array passed to build, queries call back with these indices.
+	*/
+	class Bvh{
+	public:
+		struct Node{
+			AABB bounds;
+			std::uint32_t index = 0; //First primitive in leaves, first child otherwise
+			std::uint32_t count = 0; //Number of primitives, zero for inner nodes
+
+			bool leaf() const noexcept{ return count > 0; }
+		};
+
+		Bvh() = default;
+
+		Bvh(const AABB* primitives, std::size_t count, const BvhOptions& options = {}){
+			build(primitives, count, options);
+		}
+
+		//Throws std::length_error for more than 2^31 primitives
+		void build(const AABB* primitives, std::size_t count, const BvhOptions& options = {}){
+			if(count > maxPrimitives)
+				throw std::length_error{"Bvh::build: Too many primitives"};
+
+			nodeList.clear();
+			primitiveBounds.clear();
+			primitiveIndices.resize(count);
+			std::iota(primitiveIndices.begin(), primitiveIndices.end(), std::uint32_t{0});
+
+			if(count == 0)
+				return;
+
+			BuildContext context{std::vector<AABB>(primitives, primitives + count), std::vector<Vec3f>(count), options, {1}, {}};
+
+			context.threadsAvailable = static_cast<int>(options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency())) - 1;
+			context.options.maxLeafSize = std::max<std::uint32_t>(1, options.maxLeafSize);
+
+			for(std::size_t i = 0; i < count; ++i)
+				context.centroids[i] = primitives[i].center();
+
+			nodeList.resize(count * 2 - 1);
+			build_node(context, 0, 0, static_cast<std::uint32_t>(count), 0);
+			nodeList.resize(context.nodeCount.load());
+			primitiveBounds = std::move(context.bounds);
+		}
+
+		const std::vector<Node>& nodes() const noexcept{ return nodeList; }
+		const std::vector<std::uint32_t>& primitives() const noexcept{ return primitiveIndices; } //Order the leaves refer to
+		bool empty() const noexcept{ return nodeList.empty(); }
+
+		//Calls func(primitive) for every primitive whose box overlaps box
+		template<typename Func>
+		void query(const AABB& box, Func&& func) const{
+			if(nodeList.empty())
+				return;
+
+			std::uint32_t stack[maxStackSize];
+			std::size_t stackSize = 0;
+
+			stack[stackSize++] = 0;
+
+			while(stackSize > 0){
+				const Node& node = nodeList[stack[--stackSize]];
+
+				if(!node.bounds.overlaps(box))
+					continue;
+
+				if(node.leaf()){
+					for(std::uint32_t i = node.index; i < node.index + node.count; ++i){
+						if(primitiveBounds[i].overlaps(box))
+							func(primitiveIndices[i]);
+					}
+				}else{
+					stack[stackSize++] = node.index + 1;
+					stack[stackSize++] = node.index;
+				}
+			}
+		}
+
+		/*
+		*	Closest primitive along the ray that is nearer than maxDistance.
+		*	intersect(primitive, ray, maxDistance) returns the distance to the primitive or infinity if it isn't hit.
+		*	Children are visited front to back and skipped once they are farther away than the closest hit.
+		*/
+		template<typename Intersect>
+		RayHit closest_hit(const Ray& ray, float maxDistance, Intersect&& intersect) const{
+			RayHit result;
+
+			result.distance = maxDistance;
+
+			if(nodeList.empty())
+				return result;
+
+			Vec3f invDirection = Vec3f{1.0f, 1.0f, 1.0f} / ray.direction;
+			StackEntry stack[maxStackSize];
+			std::size_t stackSize = 0;
+			StackEntry root{0, 0.0f};
+
+			if(intersect_box(nodeList[0].bounds, ray.origin, invDirection, result.distance, root.distance))
+				stack[stackSize++] = root;
+
+			while(stackSize > 0){
+				StackEntry current = stack[--stackSize];
+
+				if(current.distance > result.distance)
+					continue;
+
+				const Node& node = nodeList[current.node];
+
+				if(node.leaf()){
+					for(std::uint32_t i = node.index; i < node.index + node.count; ++i){
+						float distance = intersect(primitiveIndices[i], ray, result.distance);
+
+						if(distance < result.distance){
+							result.distance = distance;
+							result.primitive = primitiveIndices[i];
+						}
+					}
+
+					continue;
+				}
+
+				StackEntry near{node.index, 0.0f};
+				StackEntry far{node.index + 1, 0.0f};
+				bool hitNear = intersect_box(nodeList[near.node].bounds, ray.origin, invDirection, result.distance, near.distance);
+				bool hitFar = intersect_box(nodeList[far.node].bounds, ray.origin, invDirection, result.distance, far.distance);
+
+				if(hitNear && hitFar){
+					if(far.distance < near.distance)
+						std::swap(near, far);
+
+					stack[stackSize++] = far;
+					stack[stackSize++] = near;
+				}else if(hitNear || hitFar){
+					stack[stackSize++] = hitNear ? near : far;
+				}
+			}
+
+			return result;
+		}
+
+		//Batched version of query, runs on several threads
+		IndexLists query(const AABB* boxes, std::size_t count, unsigned threads = 0) const{
+			return collect_parallel(count, threads, [&](std::size_t i, std::vector<std::uint32_t>& found){
+				query(boxes[i], [&](std::uint32_t primitive){ found.push_back(primitive); });
+			});
+		}
+
+		//Batched version of closest_hit, runs on several threads so intersect must be safe to call concurrently
+		template<typename Intersect>
+		void closest_hits(const Ray* rays, std::size_t count, float maxDistance, Intersect&& intersect, RayHit* out, unsigned threads = 0) const{
+			parallel_chunks(count, threads, [&](std::size_t begin, std::size_t end){
+				for(std::size_t i = begin; i < end; ++i)
+					out[i] = closest_hit(rays[i], maxDistance, intersect);
+			});
+		}
+
+	private:
+		static constexpr std::uint32_t sahDepthLimit = 32; //Deeper nodes are split at the median, which needs at most 32 more levels
+		static constexpr std::size_t maxStackSize = sahDepthLimit * 2 + 2;
+		static constexpr int binCount = 16;
+		static constexpr std::size_t maxPrimitives = std::size_t{1} << 31; //Nodes and primitives are indexed with 32 bits and there are count * 2 - 1 nodes
+
+		//Bounds and centroids are kept in the order of primitiveIndices and moved along with it, so building reads them front to back
+		struct BuildContext{
+			std::vector<AABB> bounds;
+			std::vector<Vec3f> centroids;
+			BvhOptions options;
+			std::atomic<std::uint32_t> nodeCount;
+			std::atomic<int> threadsAvailable;
+		};
+
+		struct Bin{
+			AABB bounds;
+			std::uint32_t count = 0;
+		};
+
+		//Maps centroids along one axis to bins
+		struct Binning{
+			int axis;
+			float min;
+			float scale;
+
+			//Written so that infinite or NaN positions still end up in a valid bin
+			int of(const Vec3f centroid) const noexcept{
+				float bin = (component(centroid, axis) - min) * scale;
+
+				return bin > 0.0f ? static_cast<int>(std::min(bin, binCount - 1.0f)) : 0;
+			}
+		};
+
+		//Primitives in bins up to and including lastLeftBin go to the left child
+		struct Split{
+			Binning bins;
+			int lastLeftBin;
+		};
+
+		struct StackEntry{
+			std::uint32_t node;
+			float distance;
+		};
+
+		//Joins the thread even if the code between construction and the end of the scope throws
+		struct JoinGuard{
+			std::thread& thread;
+
+			~JoinGuard(){ thread.join(); }
+		};
+
+		std::vector<Node> nodeList;
+		std::vector<std::uint32_t> primitiveIndices;
+		std::vector<AABB> primitiveBounds; //In the same order as primitiveIndices
+
+		/*
+		*	Whether the ray enters the box no farther than maxDistance, entry is set to the distance at which it does.
+		*	A separate flag instead of an infinite distance keeps misses apart from hits when maxDistance is infinite.
+		*/
+		static bool intersect_box(const AABB& box, const Vec3f origin, const Vec3f invDirection, float maxDistance, float& entry) noexcept{
+			Vec3f t1 = (box.min - origin) * invDirection;
+			Vec3f t2 = (box.max - origin) * invDirection;
+			float enter = std::max({std::min(t1.x, t2.x), std::min(t1.y, t2.y), std::min(t1.z, t2.z), 0.0f});
+			float exit = std::min({std::max(t1.x, t2.x), std::max(t1.y, t2.y), std::max(t1.z, t2.z), maxDistance});
+
+			entry = enter;
+
+			return enter <= exit;
+		}
+
+		void build_node(BuildContext& context, std::uint32_t nodeIndex, std::uint32_t begin, std::uint32_t end, std::uint32_t depth){
+			Node& node = nodeList[nodeIndex];
+			AABB centroidBounds;
+
+			node.bounds = AABB{};
+
+			for(std::uint32_t i = begin; i < end; ++i){
+				node.bounds.extend(context.bounds[i]);
+				centroidBounds.extend(context.centroids[i]);
+			}
+
+			std::uint32_t count = end - begin;
+			int axis = centroidBounds.longest_axis();
+			float axisMin = component(centroidBounds.min, axis);
+			float axisExtent = component(centroidBounds.max, axis) - axisMin;
+
+			if(count <= context.options.maxLeafSize || !(axisExtent > 0.0f)){ //All centroids in one point can't be split
+				node.index = begin;
+				node.count = count;
+
+				return;
+			}
+
+			std::uint32_t mid = begin;
+
+			if(depth < sahDepthLimit){
+				Split split = find_sah_split(context, begin, end, centroidBounds);
+
+				mid = partition(context, begin, end, [&](const Vec3f centroid){ return split.bins.of(centroid) <= split.lastLeftBin; });
+			}
+
+			if(mid == begin || mid == end) //Median split along the longest axis
+				mid = median_split(context, begin, end, axis);
+
+			std::uint32_t children = context.nodeCount.fetch_add(2, std::memory_order_relaxed);
+
+			node.index = children;
+			node.count = 0;
+
+			if(count >= context.options.parallelThreshold && context.threadsAvailable.fetch_sub(1, std::memory_order_relaxed) > 0){
+				std::exception_ptr workerError; //Allocation failures of either half are rethrown here once both are done
+
+				{
+					std::thread worker{[&, children, begin, mid, depth]{
+						try{
+							build_node(context, children, begin, mid, depth + 1);
+						}catch(...){
+							workerError = std::current_exception();
+						}
+					}};
+					JoinGuard guard{worker};
+
+					build_node(context, children + 1, mid, end, depth + 1);
+				}
+
+				context.threadsAvailable.fetch_add(1, std::memory_order_relaxed);
+
+				if(workerError)
+					std::rethrow_exception(workerError);
+			}else{
+				if(count >= context.options.parallelThreshold)
+					context.threadsAvailable.fetch_add(1, std::memory_order_relaxed);
+
+				build_node(context, children, begin, mid, depth + 1);
+				build_node(context, children + 1, mid, end, depth + 1);
+			}
+		}
+
+		void swap_primitives(BuildContext& context, std::uint32_t a, std::uint32_t b) noexcept{
+			std::swap(primitiveIndices[a], primitiveIndices[b]);
+			std::swap(context.bounds[a], context.bounds[b]);
+			std::swap(context.centroids[a], context.centroids[b]);
+		}
+
+		//Moves the primitives whose centroid goes left to the front of [begin, end) and returns the first one that doesn't
+		template<typename GoesLeft>
+		std::uint32_t partition(BuildContext& context, std::uint32_t begin, std::uint32_t end, GoesLeft&& goesLeft) noexcept{
+			for(;;){
+				while(begin < end && goesLeft(context.centroids[begin]))
+					++begin;
+
+				while(begin < end && !goesLeft(context.centroids[end - 1]))
+					--end;
+
+				if(begin == end)
+					return begin;
+
+				swap_primitives(context, begin++, --end);
+			}
+		}
+
+		//Moves the half with the smaller centroids along axis to the front, only needed when the binned split leaves one side empty
+		std::uint32_t median_split(BuildContext& context, std::uint32_t begin, std::uint32_t end, int axis){
+			std::vector<std::uint32_t> order(end - begin);
+			std::uint32_t mid = begin + (end - begin) / 2;
+
+			std::iota(order.begin(), order.end(), begin);
+			std::nth_element(order.begin(), order.begin() + (mid - begin), order.end(), [&](std::uint32_t a, std::uint32_t b){
+				return component(context.centroids[a], axis) < component(context.centroids[b], axis);
+			});
+
+			std::vector<std::uint32_t> indices(order.size());
+			std::vector<AABB> bounds(order.size());
+			std::vector<Vec3f> centroids(order.size());
+
+			for(std::size_t i = 0; i < order.size(); ++i){
+				indices[i] = primitiveIndices[order[i]];
+				bounds[i] = context.bounds[order[i]];
+				centroids[i] = context.centroids[order[i]];
+			}
+
+			std::copy(indices.begin(), indices.end(), primitiveIndices.begin() + begin);
+			std::copy(bounds.begin(), bounds.end(), context.bounds.begin() + begin);
+			std::copy(centroids.begin(), centroids.end(), context.centroids.begin() + begin);
+
+			return mid;
+		}
+
+		/*
+		*	Sorts the centroids into bins along all three axes in one pass and picks the boundary between two bins
+		*	that minimizes the summed surface area times primitive count of both sides.
+		*/
+		Split find_sah_split(const BuildContext& context, std::uint32_t begin, std::uint32_t end, const AABB& centroidBounds) const{
+			Binning binnings[3];
+			Bin bins[3][binCount];
+
+			for(int axis = 0; axis < 3; ++axis){
+				float axisMin = component(centroidBounds.min, axis);
+				float axisExtent = component(centroidBounds.max, axis) - axisMin;
+				float scale = binCount / axisExtent;
+
+				//Flat axes and denormal extents, which would overflow the scale, put everything into the first bin and are skipped below
+				binnings[axis] = {axis, axisMin, axisExtent > 0.0f && std::isfinite(scale) ? scale : 0.0f};
+			}
+
+			for(std::uint32_t i = begin; i < end; ++i){
+				const AABB& bounds = context.bounds[i];
+				const Vec3f centroid = context.centroids[i];
+
+				for(int axis = 0; axis < 3; ++axis){
+					Bin& bin = bins[axis][binnings[axis].of(centroid)];
+
+					bin.bounds.extend(bounds);
+					++bin.count;
+				}
+			}
+
+			float bestCost = std::numeric_limits<float>::infinity();
+			Split best{{0, 0.0f, 0.0f}, binCount};
+
+			for(int axis = 0; axis < 3; ++axis){
+				if(binnings[axis].scale == 0.0f)
+					continue;
+
+				float rightCost[binCount];
+				AABB right;
+				std::uint32_t rightCount = 0;
+
+				for(int i = binCount - 1; i > 0; --i){
+					right.extend(bins[axis][i].bounds);
+					rightCount += bins[axis][i].count;
+					rightCost[i] = rightCount * right.surface_area();
+				}
+
+				AABB left;
+				std::uint32_t leftCount = 0;
+
+				for(int i = 0; i < binCount - 1; ++i){
+					left.extend(bins[axis][i].bounds);
+					leftCount += bins[axis][i].count;
+
+					float cost = leftCount * left.surface_area() + rightCost[i + 1];
+
+					if(leftCount > 0 && leftCount < end - begin && cost < bestCost){
+						bestCost = cost;
+						best = {binnings[axis], i};
+					}
+				}
+			}
+
+			return best;
+		}
+	};
+
+	/*
+	*	Hash grid over points for radius queries.
+	*	Points are sorted by cell so that the points of a cell are next to each other in memory.
+	*	Queries visit every cell overlapping the bounding box of the sphere, so the cell size should be close to the query radius.
+	*/
+	class PointGrid{
+	public:
+		PointGrid() = default;
+
+		PointGrid(const Vec3f* points, std::size_t count, float cellSize){
+			build(points, count, cellSize);
+		}
+
+		//Throws std::invalid_argument if cellSize isn't a positive finite number and std::length_error for more than 2^32 - 1 points
+		void build(const Vec3f* points, std::size_t count, float cellSize){
+			if(!(cellSize > 0.0f) || !std::isfinite(cellSize) || !std::isfinite(1.0f / cellSize)) //Denormal sizes would overflow the inverse
+				throw std::invalid_argument{"PointGrid::build: Cell size must be positive and finite"};
+
+			if(count > std::numeric_limits<std::uint32_t>::max()) //Points are indexed with 32 bits
+				throw std::length_error{"PointGrid::build: Too many points"};
+
+			invCellSize = 1.0f / cellSize;
+
+			std::size_t bucketCount = 1;
+
+			while(bucketCount < count)
+				bucketCount *= 2;
+
+			bucketBits = 0;
+
+			while((std::size_t{1} << bucketBits) < bucketCount)
+				++bucketBits;
+
+			std::vector<std::uint64_t> pointKeys(count);
+
+			bucketStart.assign(bucketCount + 1, 0);
+
+			for(std::size_t i = 0; i < count; ++i){
+				pointKeys[i] = cell_key(cell_of(points[i].x), cell_of(points[i].y), cell_of(points[i].z));
+				++bucketStart[bucket_of(pointKeys[i]) + 1];
+			}
+
+			for(std::size_t i = 0; i < bucketCount; ++i)
+				bucketStart[i + 1] += bucketStart[i];
+
+			std::vector<std::uint32_t> next(bucketStart.begin(), bucketStart.end() - 1);
+
+			keys.resize(count);
+			indices.resize(count);
+			positions.resize(count);
+
+			for(std::size_t i = 0; i < count; ++i){
+				std::uint32_t slot = next[bucket_of(pointKeys[i])]++;
+
+				keys[slot] = pointKeys[i];
+				indices[slot] = static_cast<std::uint32_t>(i);
+				positions[slot] = points[i];
+			}
+		}
+
+		std::size_t size() const noexcept{ return indices.size(); }
+
+		/*
+		*	Calls func(index) for every point within radius of center.
+		*	Visits at most min(cells overlapping the sphere's bounding box, size()) cells or points:
+		*	when the box covers more cells than there are points, all points are checked directly instead.
+		*/
+		template<typename Func>
+		void for_each_in_radius(const Vec3f center, float radius, Func&& func) const{
+			if(indices.empty() || !(radius >= 0.0f))
+				return;
+
+			float radiusSq = radius * radius;
+			std::int32_t minX = cell_of(center.x - radius), maxX = cell_of(center.x + radius);
+			std::int32_t minY = cell_of(center.y - radius), maxY = cell_of(center.y + radius);
+			std::int32_t minZ = cell_of(center.z - radius), maxZ = cell_of(center.z + radius);
+			auto span = [](std::int32_t min, std::int32_t max){ return static_cast<double>(max) - min + 1.0; }; //Can't overflow unlike int32
+			double cellCount = span(minX, maxX) * span(minY, maxY) * span(minZ, maxZ);
+
+			//Also keeps ranges of 2^21 or more cells from visiting the same key twice
+			if(cellCount > static_cast<double>(indices.size())){
+				for(std::size_t i = 0; i < positions.size(); ++i){
+					if((positions[i] - center).length_sq() <= radiusSq)
+						func(indices[i]);
+				}
+
+				return;
+			}
+
+			for(std::int32_t x = minX; x <= maxX; ++x){
+				for(std::int32_t y = minY; y <= maxY; ++y){
+					for(std::int32_t z = minZ; z <= maxZ; ++z){
+						std::uint64_t key = cell_key(x, y, z);
+						std::size_t bucket = bucket_of(key);
+
+						for(std::uint32_t i = bucketStart[bucket]; i < bucketStart[bucket + 1]; ++i){
+							if(keys[i] == key && (positions[i] - center).length_sq() <= radiusSq) //Other cells can share the bucket
+								func(indices[i]);
+						}
+					}
+				}
+			}
+		}
+
+		//Batched version of for_each_in_radius, runs on several threads
+		IndexLists find_in_radius(const Vec3f* centers, std::size_t count, float radius, unsigned threads = 0) const{
+			return collect_parallel(count, threads, [&](std::size_t i, std::vector<std::uint32_t>& found){
+				for_each_in_radius(centers[i], radius, [&](std::uint32_t index){ found.push_back(index); });
+			});
+		}
+
+	private:
+		float invCellSize = 1.0f;
+		unsigned bucketBits = 0;
+		std::vector<std::uint32_t> bucketStart; //Points of bucket b are in [bucketStart[b], bucketStart[b + 1])
+		std::vector<std::uint64_t> keys;
+		std::vector<std::uint32_t> indices;
+		std::vector<Vec3f> positions;
+
+		//Clamped so that huge coordinates don't overflow, far away cells then merge which only costs time
+		std::int32_t cell_of(float coordinate) const noexcept{
+			return static_cast<std::int32_t>(std::floor(std::clamp(coordinate * invCellSize, -1e9f, 1e9f)));
+		}
+
+		//21 bits per axis, cells that are 2^21 apart share a key and are told apart by the distance check
+		static std::uint64_t cell_key(std::int32_t x, std::int32_t y, std::int32_t z) noexcept{
+			constexpr std::uint64_t mask = (1 << 21) - 1;
+
+			return ((static_cast<std::uint64_t>(x) & mask) << 42) | ((static_cast<std::uint64_t>(y) & mask) << 21) | (static_cast<std::uint64_t>(z) & mask);
+		}
+
+		std::size_t bucket_of(std::uint64_t key) const noexcept{
+			return bucketBits == 0 ? 0 : static_cast<std::size_t>((key * 0x9e3779b97f4a7c15) >> (64 - bucketBits));
+		}
+	};
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <shared_mutex>
+#include "stringUtil.h"
+
+namespace util{
+	//Small handle to a string in a StringPool, two ids from the same pool are equal exactly if their strings are
+	struct StringId{
+		static constexpr std::uint32_t invalid = std::numeric_limits<std::uint32_t>::max();
+
+		std::uint32_t value = invalid;
+
+		constexpr bool valid() const noexcept{ return value != invalid; }
+		constexpr explicit operator bool() const noexcept{ return valid(); }
+
+		constexpr bool operator==(StringId other) const noexcept{ return value == other.value; }
+		constexpr bool operator!=(StringId other) const noexcept{ return value != other.value; }
+		constexpr bool operator<(StringId other) const noexcept{ return value < other.value; }
+	};
+
+	/*
+	*	Thread-safe string interning.
+	*	Every distinct string is stored once in an arena and gets a dense id starting at zero.
+	*	Strings are never removed, so ids and the views returned by view() stay valid for as long as the pool is alive.
+	*	Looking up the string of an id doesn't lock, interning takes a shared lock unless the string is new.
+	*	view() may be called concurrently with intern() for any id the calling thread got from intern() or find() itself
+	*	or received through something that synchronizes, like a mutex, a thread being started or an acquire load.
+	*	An id that merely became visible without such synchronization, e.g. through a relaxed atomic, may not be looked up.
+	*	Traits provide static std::uint64_t hash(std::string_view) and bool equal(std::string_view, std::string_view).
+	*/
+	template<typename Traits>
+	class BasicStringPool{
+	public:
+		BasicStringPool() = default;
+		BasicStringPool(const BasicStringPool&) = delete;
+		BasicStringPool& operator=(const BasicStringPool&) = delete;
+
+		~BasicStringPool(){
+			for(auto& block : blocks)
+				delete[] block.load(std::memory_order_relaxed);
+		}
+
+		//Pool shared by the whole process
+		static BasicStringPool& global(){
+			static BasicStringPool pool;
+
+			return pool;
+		}
+
+		//Returns the id of s, adding it to the pool if it isn't there yet
+		StringId intern(std::string_view s){
+			std::uint64_t hash = Traits::hash(s);
+
+			{
+				std::shared_lock<std::shared_mutex> lock{mutex};
+				StringId id = find_id(s, hash);
+
+				if(id)
+					return id;
+			}
+
+			std::unique_lock<std::shared_mutex> lock{mutex};
+			StringId id = find_id(s, hash); //Another thread might have added it in the meantime
+
+			if(id)
+				return id;
+
+			if(count == maxStrings)
+				throw std::length_error{"StringPool::intern: Too many strings"};
+
+			id.value = count;
+
+			std::size_t block = id.value / blockSize;
+
+			if(!blocks[block].load(std::memory_order_relaxed))
+				blocks[block].store(new std::string_view[blockSize], std::memory_order_release);
+
+			blocks[block].load(std::memory_order_relaxed)[id.value % blockSize] = store(s);
+
+			if((count + 1) * 2 > index.size())
+				rehash(std::max<std::size_t>(64, index.size() * 2));
+
+			insert_slot(hash, id.value);
+			stringCount.store(++count, std::memory_order_release);
+
+			return id;
+		}
+
+		//Returns the id of s or an invalid id if it hasn't been interned
+		StringId find(std::string_view s) const{
+			std::shared_lock<std::shared_mutex> lock{mutex};
+
+			return find_id(s, Traits::hash(s));
+		}
+
+		//The string as it was first interned, id must come from this pool
+		std::string_view view(StringId id) const noexcept{
+			return blocks[id.value / blockSize].load(std::memory_order_acquire)[id.value % blockSize];
+		}
+
+		std::size_t size() const noexcept{ return stringCount.load(std::memory_order_acquire); }
+
+	private:
+		static constexpr std::size_t blockSize = 4096;
+		static constexpr std::size_t maxBlocks = 4096;
+		static constexpr std::uint32_t maxStrings = blockSize * maxBlocks;
+		static constexpr std::size_t chunkSize = 64 * 1024;
+
+		struct IndexSlot{
+			std::uint64_t hash = 0;
+			std::uint32_t id = StringId::invalid;
+		};
+
+		mutable std::shared_mutex mutex;
+		std::array<std::atomic<std::string_view*>, maxBlocks> blocks{}; //Fixed size blocks of views so that view() never sees them move
+		std::vector<IndexSlot> index; //Open addressing table over ids, size is always zero or a power of two
+		std::vector<std::unique_ptr<char[]>> chunks; //Arena the strings are stored in
+		std::vector<std::unique_ptr<char[]>> largeStrings;
+		std::size_t chunkUsed = chunkSize;
+		std::uint32_t count = 0;
+		std::atomic<std::uint32_t> stringCount = 0;
+
+		StringId find_id(std::string_view s, std::uint64_t hash) const noexcept{
+			if(index.empty())
+				return {};
+
+			std::size_t mask = index.size() - 1;
+
+			for(std::size_t i = static_cast<std::size_t>(hash) & mask; index[i].id != StringId::invalid; i = (i + 1) & mask){
+				if(index[i].hash == hash && Traits::equal(view(StringId{index[i].id}), s))
+					return StringId{index[i].id};
+			}
+
+			return {};
+		}
+
+		void insert_slot(std::uint64_t hash, std::uint32_t id) noexcept{
+			std::size_t mask = index.size() - 1;
+			std::size_t i = static_cast<std::size_t>(hash) & mask;
+
+			while(index[i].id != StringId::invalid)
+				i = (i + 1) & mask;
+
+			index[i] = IndexSlot{hash, id};
+		}
+
+		void rehash(std::size_t size){
+			std::vector<IndexSlot> oldIndex(size);
+
+			oldIndex.swap(index);
+
+			for(const IndexSlot& slot : oldIndex){
+				if(slot.id != StringId::invalid)
+					insert_slot(slot.hash, slot.id);
+			}
+		}
+
+		//Copies s into the arena, strings that don't fit into a chunk get one of their own
+		std::string_view store(std::string_view s){
+			if(s.empty())
+				return {};
+
+			if(s.size() > chunkSize / 4){
+				largeStrings.push_back(std::make_unique<char[]>(s.size()));
+				std::memcpy(largeStrings.back().get(), s.data(), s.size());
+
+				return {largeStrings.back().get(), s.size()};
+			}
+
+			if(chunkUsed + s.size() > chunkSize){
+				chunks.push_back(std::make_unique<char[]>(chunkSize));
+				chunkUsed = 0;
+			}
+
+			char* data = chunks.back().get() + chunkUsed;
+
+			std::memcpy(data, s.data(), s.size());
+			chunkUsed += s.size();
+
+			return {data, s.size()};
+		}
+	};
+
+	struct CaseSensitiveStringTraits{
+		static std::uint64_t hash(std::string_view s) noexcept{ return std::hash<std::string_view>{}(s); }
+		static bool equal(std::string_view s1, std::string_view s2) noexcept{ return s1 == s2; }
+	};
+
+	//Strings that only differ in ASCII case share an id, view() returns the spelling that was interned first
+	struct CaseInsensitiveStringTraits{
+		static std::uint64_t hash(std::string_view s) noexcept{ return str::hash_ignore_case(s); }
+		static bool equal(std::string_view s1, std::string_view s2) noexcept{ return str::equals_ignore_case(s1, s2); }
+	};
+
+	using StringPool = BasicStringPool<CaseSensitiveStringTraits>;
+	using CaseInsensitiveStringPool = BasicStringPool<CaseInsensitiveStringTraits>;
+}
+
+namespace std{
+	template<>
+	struct hash<util::StringId>{
+		std::size_t operator()(util::StringId id) const noexcept{ return id.value; }
+	};
+}
@@ -1,134 +1,506 @@
 #pragma once
 
+#include <cmath>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <chrono>
+#include <limits>
 #include <string>
 #include <cctype>
 #include <vector>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <charconv>
+#include <iterator>
 #include <algorithm>
 #include <string_view>
+#include <type_traits>
+#include <system_error>
+#include "simd.h"
 
 #define UTIL_STR(x) #x
 #define UTIL_STRINGIFY(x) UTIL_STR(x)
 
 namespace util::str{
+	constexpr bool is_path_separator(char c) noexcept{ return c == '/' || c == '\\'; }
+
 	//Removes path and returns only file name with extension
-	inline std::string file_name(const std::string& path){
+	constexpr std::string_view file_name_view(std::string_view path) noexcept{
 		std::size_t index = path.find_last_of("\\/");
 
-		if(index == std::string::npos)
-			index = 0;
-		else
-			++index;
-
-		return path.substr(index, path.length());
+		return index == std::string_view::npos ? path : path.substr(index + 1);
 	}
 
-	//Removes file name and returns only path
-	inline std::string path(const std::string& path){
+	//Removes file name and returns only path including the trailing separator
+	constexpr std::string_view path_view(std::string_view path) noexcept{
 		std::size_t index = path.find_last_of("\\/");
 
-		if(index == std::string::npos || index == path.length())
-			index = 0;
-		else
-			++index;
-
-		return path.substr(0, index);
+		return index == std::string_view::npos ? std::string_view{} : path.substr(0, index + 1);
 	}
 
 	//Removes file extension from single file name or path with file name
-	inline std::string without_file_extension(const std::string& fileName){
-		std::size_t extPos = fileName.find_last_of(".");
+	constexpr std::string_view without_file_extension_view(std::string_view fileName) noexcept{
+		std::size_t extPos = fileName.find_last_of('.');
 		std::size_t pathPos = fileName.find_last_of("\\/");
 
-		if(extPos != std::string::npos){
-			if(pathPos == std::string::npos || pathPos < extPos)
-				return fileName.substr(0, extPos);
-		}
+		if(extPos != std::string_view::npos && (pathPos == std::string_view::npos || pathPos < extPos))
+			return fileName.substr(0, extPos);
 
 		return fileName;
 	}
 
-	//Returns file extension of specified file name or empty string if there was none
-	inline std::string file_extension(std::string_view fileName){
-		std::size_t exPos = fileName.find_last_of(".");
-		std::string ext;
+	//Returns file extension including the dot or an empty view if there is none, dots in directory names are ignored
+	constexpr std::string_view file_extension_view(std::string_view fileName) noexcept{
+		std::string_view name = file_name_view(fileName);
+		std::size_t extPos = name.find_last_of('.');
 
-		if(exPos != std::string_view::npos){
-			ext = fileName.substr(exPos, fileName.length());
+		if(extPos == std::string_view::npos || extPos + 1 == name.size())
+			return {};
 
-			if(ext.length() == 1)
-				ext = "";
-		}else{
-			ext = "";
+		return name.substr(extPos);
+	}
+
+	inline std::string file_name(std::string_view path){
+		return std::string{file_name_view(path)};
+	}
+
+	inline std::string path(std::string_view path){
+		return std::string{path_view(path)};
+	}
+
+	inline std::string without_file_extension(std::string_view fileName){
+		return std::string{without_file_extension_view(fileName)};
+	}
+
+	inline std::string file_extension(std::string_view fileName){
+		return std::string{file_extension_view(fileName)};
+	}
+
+	/*
+	*	Appends paths to out, adding separators where needed.
+	*	The existing contents of out count as the first path, so a buffer can be reused by clearing it first.
+	*	Empty paths are skipped. The final length is computed up front so out grows at most once.
+	*/
+	template<typename ... Args>
+	void append_paths(std::string& out, const Args& ...paths){
+		const std::string_view parts[] = {std::string_view{paths}...};
+		auto needsSeparator = [](char last, std::string_view part){
+			return last != '\0' && !is_path_separator(last) && !is_path_separator(part.front());
+		};
+
+		std::size_t length = out.size();
+		char last = out.empty() ? '\0' : out.back();
+
+		for(std::string_view part : parts){
+			if(!part.empty()){
+				length += part.size() + needsSeparator(last, part);
+				last = part.back();
+			}
 		}
 
-		return ext;
+		std::size_t pos = out.size();
+
+		last = out.empty() ? '\0' : out.back();
+		out.resize(length);
+
+		for(std::string_view part : parts){
+			if(!part.empty()){
+				if(needsSeparator(last, part))
+					out[pos++] = '/';
+
+				pos += part.copy(out.data() + pos, part.size());
+				last = part.back();
+			}
+		}
 	}
 
 	//Joins paths adding separators if needed
-	inline std::string join_paths(std::string_view result){
-		return result.data();
+	template<typename ... Args>
+	std::string join_paths(const Args& ...paths){
+		std::string result;
+
+		append_paths(result, paths...);
+
+		return result;
 	}
 
-	template<typename ... Args>
-	std::string join_paths(std::string_view p1, std::string_view p2, Args&& ...args){
-		std::string joinedPath;
+	/*
+	*	ASCII case conversion and comparison.
+	*	Only A-Z and a-z are affected no matter which locale is active, every other byte is left as it is.
+	*	The kernels work on 32 characters at a time if the CPU supports AVX2 and on 16 with SSE2.
+	*/
 
-		if(p1.back() != '/' && p1.back() != '\\' && p2[0] != '/' && p2[0] != '\\')
-			joinedPath = std::string{p1} + "/" + p2.data();
-		else
-			joinedPath = std::string{p1} + p2.data();
+	constexpr char to_lower_ascii(char c) noexcept{ return c >= 'A' && c <= 'Z' ? static_cast<char>(c + ('a' - 'A')) : c; }
+	constexpr char to_upper_ascii(char c) noexcept{ return c >= 'a' && c <= 'z' ? static_cast<char>(c - ('a' - 'A')) : c; }
+
+	//Converts size characters from src and writes them to dst, both may be the same
+	template<bool Upper>
+	void change_case_scalar(const char* src, char* dst, std::size_t size) noexcept{
+		for(std::size_t i = 0; i < size; ++i)
+			dst[i] = Upper ? to_upper_ascii(src[i]) : to_lower_ascii(src[i]);
+	}
+
+	//Returns the index of the first character that differs when ignoring case or size if there is none
+	inline std::size_t mismatch_ignore_case_scalar(const char* s1, const char* s2, std::size_t size) noexcept{
+		std::size_t i = 0;
+
+		while(i < size && to_lower_ascii(s1[i]) == to_lower_ascii(s2[i]))
+			++i;
+
+		return i;
+	}
+
+#ifdef UTIL_SSE2
+	//Sets the case bit of all letters of the other case, shifting the range so that it can be checked with one signed compare
+	template<bool Upper>
+	__m128i change_case_sse2(__m128i chars) noexcept{
+		__m128i shifted = _mm_add_epi8(chars, _mm_set1_epi8(static_cast<char>(-128 - (Upper ? 'a' : 'A'))));
+		__m128i isOtherCase = _mm_cmplt_epi8(shifted, _mm_set1_epi8(-128 + 26));
+
+		return _mm_xor_si128(chars, _mm_and_si128(isOtherCase, _mm_set1_epi8(0x20)));
+	}
+
+	template<bool Upper>
+	void change_case_sse2(const char* src, char* dst, std::size_t size) noexcept{
+		std::size_t i = 0;
+
+		for(; i + 16 <= size; i += 16)
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), change_case_sse2<Upper>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+
+		change_case_scalar<Upper>(src + i, dst + i, size - i);
+	}
+
+	inline std::size_t mismatch_ignore_case_sse2(const char* s1, const char* s2, std::size_t size) noexcept{
+		std::size_t i = 0;
+
+		for(; i + 16 <= size; i += 16){
+			__m128i a = change_case_sse2<false>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + i)));
+			__m128i b = change_case_sse2<false>(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s2 + i)));
+			auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a, b))) ^ 0xFFFFu;
+
+			if(mask)
+				return i + simd::count_trailing_zeros(mask);
+		}
+
+		return i + mismatch_ignore_case_scalar(s1 + i, s2 + i, size - i);
+	}
+#endif
+
+#ifdef UTIL_AVX2_DISPATCH
+	template<bool Upper>
+	UTIL_TARGET_AVX2 __m256i change_case_avx2(__m256i chars) noexcept{
+		__m256i shifted = _mm256_add_epi8(chars, _mm256_set1_epi8(static_cast<char>(-128 - (Upper ? 'a' : 'A'))));
+		__m256i isOtherCase = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 26), shifted);
+
+		return _mm256_xor_si256(chars, _mm256_and_si256(isOtherCase, _mm256_set1_epi8(0x20)));
+	}
+
+	template<bool Upper>
+	UTIL_TARGET_AVX2 void change_case_avx2(const char* src, char* dst, std::size_t size) noexcept{
+		std::size_t i = 0;
+
+		for(; i + 32 <= size; i += 32)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), change_case_avx2<Upper>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+
+		change_case_scalar<Upper>(src + i, dst + i, size - i);
+	}
+
+	UTIL_TARGET_AVX2 inline std::size_t mismatch_ignore_case_avx2(const char* s1, const char* s2, std::size_t size) noexcept{
+		std::size_t i = 0;
+
+		for(; i + 32 <= size; i += 32){
+			__m256i a = change_case_avx2<false>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s1 + i)));
+			__m256i b = change_case_avx2<false>(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(s2 + i)));
+			auto mask = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b)));
+
+			if(mask)
+				return i + simd::count_trailing_zeros(mask);
+		}
+
+		return i + mismatch_ignore_case_scalar(s1 + i, s2 + i, size - i);
+	}
+#endif
+
+	template<bool Upper>
+	void change_case(const char* src, char* dst, std::size_t size) noexcept{
+#ifdef UTIL_AVX2_DISPATCH
+		if(size >= 32 && simd::has_avx2())
+			return change_case_avx2<Upper>(src, dst, size);
+#endif
+#ifdef UTIL_SSE2
+		change_case_sse2<Upper>(src, dst, size);
+#else
+		change_case_scalar<Upper>(src, dst, size);
+#endif
+	}
+
+	inline std::size_t mismatch_ignore_case(const char* s1, const char* s2, std::size_t size) noexcept{
+#ifdef UTIL_AVX2_DISPATCH
+		if(size >= 32 && simd::has_avx2())
+			return mismatch_ignore_case_avx2(s1, s2, size);
+#endif
+#ifdef UTIL_SSE2
+		return mismatch_ignore_case_sse2(s1, s2, size);
+#else
+		return mismatch_ignore_case_scalar(s1, s2, size);
+#endif
+	}
+
+	//Writes s.size() lower case characters to out, which may also point to s itself
+	inline void to_lower(std::string_view s, char* out) noexcept{
+		change_case<false>(s.data(), out, s.size());
+	}
+
+	//Writes s.size() upper case characters to out, which may also point to s itself
+	inline void to_upper(std::string_view s, char* out) noexcept{
+		change_case<true>(s.data(), out, s.size());
+	}
 
-		return join_paths(joinedPath, args...);
+	inline void to_lower_in_place(std::string& s) noexcept{
+		to_lower(s, s.data());
+	}
+
+	inline void to_upper_in_place(std::string& s) noexcept{
+		to_upper(s, s.data());
 	}
 
 	//Converts string to lower case
 	inline std::string to_lower(std::string_view s){
-		std::string result;
-
-		result.reserve(s.size());
+		std::string result(s.size(), '\0');
 
-		for(char c : s)
-			result += static_cast<char>(std::tolower(c));
+		to_lower(s, result.data());
 
 		return result;
 	}
 
 	//Converts string to upper case
 	inline std::string to_upper(std::string_view s){
-		std::string result;
-
-		result.reserve(s.size());
+		std::string result(s.size(), '\0');
 
-		for(char c : s)
-			result += static_cast<char>(std::toupper(c));
+		to_upper(s, result.data());
 
 		return result;
 	}
 
+	inline bool equals_ignore_case(std::string_view s1, std::string_view s2) noexcept{
+		return s1.size() == s2.size() && mismatch_ignore_case(s1.data(), s2.data(), s1.size()) == s1.size();
+	}
+
+	//Orders like std::string_view::compare on the lower case versions of both strings
+	inline int compare_ignore_case(std::string_view s1, std::string_view s2) noexcept{
+		std::size_t size = std::min(s1.size(), s2.size());
+		std::size_t i = mismatch_ignore_case(s1.data(), s2.data(), size);
+
+		if(i < size)
+			return static_cast<unsigned char>(to_lower_ascii(s1[i])) < static_cast<unsigned char>(to_lower_ascii(s2[i])) ? -1 : 1;
+
+		return s1.size() < s2.size() ? -1 : s1.size() > s2.size() ? 1 : 0;
+	}
+
+	//Vectorized searching
+
+	//Matches a single character
+	struct CharMatch{
+		char c;
+
+		bool operator()(char other) const noexcept{ return other == c; }
+#ifdef UTIL_SSE2
+		__m128i operator()(__m128i chars) const noexcept{ return _mm_cmpeq_epi8(chars, _mm_set1_epi8(c)); }
+#endif
+#ifdef UTIL_AVX2
+		__m256i operator()(__m256i chars) const noexcept{ return _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(c)); }
+#endif
+	};
+
+	//Matches the same characters as std::isspace in the "C" locale, or every other character if negated
+	struct WhitespaceMatch{
+		bool negate = false;
+
+		bool operator()(char c) const noexcept{ return (c == ' ' || (c >= '\t' && c <= '\r')) != negate; }
+#ifdef UTIL_SSE2
+		__m128i operator()(__m128i chars) const noexcept{
+			__m128i controls = _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8('\t' - 1)), _mm_cmplt_epi8(chars, _mm_set1_epi8('\r' + 1)));
+			__m128i result = _mm_or_si128(_mm_cmpeq_epi8(chars, _mm_set1_epi8(' ')), controls);
+
+			return negate ? _mm_xor_si128(result, _mm_set1_epi8(-1)) : result;
+		}
+#endif
+#ifdef UTIL_AVX2
+		__m256i operator()(__m256i chars) const noexcept{
+			__m256i controls = _mm256_and_si256(_mm256_cmpgt_epi8(chars, _mm256_set1_epi8('\t' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('\r' + 1), chars));
+			__m256i result = _mm256_or_si256(_mm256_cmpeq_epi8(chars, _mm256_set1_epi8(' ')), controls);
+
+			return negate ? _mm256_xor_si256(result, _mm256_set1_epi8(-1)) : result;
+		}
+#endif
+	};
+
+	/*
+	*	Returns the position of the first character at or after pos that matches or npos if there is none.
+	*	Checks 32 or 16 characters at a time if AVX2 or SSE2 are enabled.
+	*/
+	template<typename Match>
+	std::size_t find_first(std::string_view s, Match match, std::size_t pos = 0) noexcept{
+		const char* data = s.data();
+		std::size_t size = s.size();
+
+#ifdef UTIL_AVX2
+		for(; pos + 32 <= size; pos += 32){
+			auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(match(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos)))));
+
+			if(mask)
+				return pos + simd::count_trailing_zeros(mask);
+		}
+#endif
+#ifdef UTIL_SSE2
+		for(; pos + 16 <= size; pos += 16){
+			auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(match(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos)))));
+
+			if(mask)
+				return pos + simd::count_trailing_zeros(mask);
+		}
+#endif
+		for(; pos < size; ++pos){
+			if(match(data[pos]))
+				return pos;
+		}
+
+		return std::string_view::npos;
+	}
+
+	/*
+	*	Lazily splits a string into views of its tokens without copying or allocating.
+	*	Splits either at runs of whitespaces or at a delimiter, in which case empty fields can optionally be kept.
+	*	The string being split needs to outlive the range.
+	*		for(std::string_view token : str::split_range(line, ',', true))
+	*/
+	class SplitRange{
+	public:
+		class iterator{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = std::string_view;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const std::string_view*;
+			using reference = const std::string_view&;
+
+			iterator() = default;
+
+			reference operator*() const noexcept{ return token; }
+			pointer operator->() const noexcept{ return &token; }
+
+			iterator& operator++() noexcept{
+				advance();
+
+				return *this;
+			}
+
+			iterator operator++(int) noexcept{
+				iterator result{*this};
+
+				advance();
+
+				return result;
+			}
+
+			bool operator==(const iterator& other) const noexcept{ return next == other.next; }
+			bool operator!=(const iterator& other) const noexcept{ return next != other.next; }
+
+		private:
+			friend class SplitRange;
+
+			static constexpr std::size_t end = std::string_view::npos;
+
+			const SplitRange* range = nullptr;
+			std::string_view token;
+			std::size_t next = end; //Where to continue searching, end once there are no tokens left
+
+			iterator(const SplitRange* range, std::size_t next) noexcept : range{range}, next{next}{
+				advance();
+			}
+
+			void advance() noexcept{
+				std::string_view s = range->s;
+
+				if(next == end)
+					return;
+
+				if(range->whitespace){
+					std::size_t start = find_first(s, WhitespaceMatch{true}, next);
+
+					if(start == std::string_view::npos){
+						next = end;
+
+						return;
+					}
+
+					std::size_t stop = std::min(find_first(s, WhitespaceMatch{}, start), s.size());
+
+					token = s.substr(start, stop - start);
+					next = stop;
+				}else{
+					do{
+						if(next > s.size()){
+							next = end;
+
+							return;
+						}
+
+						std::size_t stop = std::min(find_first(s, CharMatch{range->delimiter}, next), s.size());
+
+						token = s.substr(next, stop - next);
+						next = stop + 1;
+					}while(token.empty() && !range->keepEmpty);
+				}
+			}
+		};
+
+		using const_iterator = iterator;
+
+		SplitRange(std::string_view s) noexcept : s{s}{}
+		SplitRange(std::string_view s, char delimiter, bool keepEmpty) noexcept : s{s}, delimiter{delimiter}, whitespace{false}, keepEmpty{keepEmpty}{}
+
+		iterator begin() const noexcept{ return iterator{this, 0}; }
+		iterator end() const noexcept{ return iterator{}; }
+
+	private:
+		std::string_view s;
+		char delimiter = ' ';
+		bool whitespace = true;
+		bool keepEmpty = false;
+	};
+
+	//Splits at runs of whitespaces
+	inline SplitRange split_range(std::string_view s) noexcept{
+		return SplitRange{s};
+	}
+
+	//Splits at every occurrence of delimiter, empty fields are skipped unless keepEmpty is true
+	inline SplitRange split_range(std::string_view s, char delimiter, bool keepEmpty = false) noexcept{
+		return SplitRange{s, delimiter, keepEmpty};
+	}
+
 	//Extracts single words from string and stores them in a vector
 	inline std::vector<std::string> split(std::string_view s){
-		std::istringstream iss{s.data()};
 		std::vector<std::string> result;
-		std::string temp;
 
-		while(iss >> temp)
-			result.push_back(temp);
+		for(std::string_view word : split_range(s))
+			result.emplace_back(word);
 
 		return result;
 	}
 
 	//Splits string at specified delimiter and returns vector of separated strings
 	inline std::vector<std::string> split_at(std::string_view s, char delimiter){
-		std::istringstream iss{s.data()};
 		std::vector<std::string> result;
-		std::string temp;
 
-		while(std::getline(iss, temp, delimiter)){
-			if(!temp.empty())
-				result.push_back(temp);
-		}
+		for(std::string_view token : split_range(s, delimiter))
+			result.emplace_back(token);
 
 		return result;
 	}
@@ -138,15 +510,318 @@ namespace util::str{
 	template<typename T>
 	std::string to_string(T value);
 
+	/*
+	*	Writes value to [first, last) and returns the end of the written characters, fails with std::errc::value_too_large.
+	*	Handles the same types as from_string except for arbitrary classes, everything written can be read back by it.
+	*	Floating point values are written in the shortest form that converts back to exactly the same value.
+	*/
+	template<typename T>
+	std::to_chars_result to_chars(char* first, char* last, const T& value);
+
+	//Appends value to s, formatted like to_chars, without creating a temporary string
+	template<typename T>
+	void append_string(std::string& s, const T& value);
+
+	//Throws std::invalid_argument or std::out_of_range if the string couldn't be converted
 	template<typename T>
 	T to_value(const std::string& string);
 
-	inline void to_string_vector(std::vector<std::string>&){} //Dummy used to end recursion
+	//Result of a conversion that carries an error instead of throwing
+	template<typename T>
+	struct ParseResult{
+		T value{};
+		std::errc error{};
+
+		explicit operator bool() const noexcept{ return error == std::errc{}; }
+		T value_or(T defaultValue) const{ return error == std::errc{} ? value : defaultValue; }
+	};
+
+	/*
+	*	Non-throwing conversion from a string view that doesn't allocate for arithmetic types, enums and std::chrono::durations.
+	*	Durations are written as a number followed by a unit (ns, us, ms, s, min or m, h, d), e.g. 1.5s or 250ms.
+	*	They are rounded to the nearest count of the duration type, e.g. std::chrono::seconds reads 1.5ms as 0s and 600ms as 1s.
+	*	Infinity and NaN are invalid.
+	*	A char is the single character itself, just like to_string writes it, signed and unsigned char are numbers.
+	*	A bool is true, false (ignoring case), 1 or 0.
+	*	Returns std::errc::invalid_argument or std::errc::result_out_of_range and leaves value untouched
+	*	if the whole string couldn't be converted.
+	*/
+	template<typename T>
+	std::errc from_string(std::string_view s, T& value);
+
+	//Like from_string but ignores whitespaces around the value, this is what to_value and Config use
+	template<typename T>
+	ParseResult<T> parse_value(std::string_view s);
+
+	//Parses a number of bytes with an optional unit, K, M, G and T as well as KiB etc. are binary, KB etc. are decimal
+	inline std::errc parse_byte_size(std::string_view s, std::uint64_t& bytes);
+
+	/*
+	*	Parses a {N} placeholder starting at fmt[pos].
+	*	Returns the position after the closing brace and stores N in index or returns npos if there is no valid placeholder.
+	*/
+	constexpr std::size_t parse_placeholder(std::string_view fmt, std::size_t pos, std::size_t& index) noexcept{
+		std::size_t i = pos + 1;
+
+		index = 0;
+
+		constexpr std::size_t maxIndex = std::numeric_limits<std::size_t>::max() / 10 - 1; //Larger indices can't have an argument anyway
+
+		while(i < fmt.size() && fmt[i] >= '0' && fmt[i] <= '9')
+			index = std::min(index * 10 + static_cast<std::size_t>(fmt[i++] - '0'), maxIndex);
+
+		if(i == pos + 1 || i == fmt.size() || fmt[i] != '}' || index == 0 || index == maxIndex)
+			return std::string_view::npos;
+
+		return i + 1;
+	}
+
+	/*
+	*	Returns the end of the text starting with a brace at fmt[pos] that parse_placeholder rejected.
+	*	A brace that stops the digits is part of that text just like it was before placeholders were parsed at compile time,
+	*	so a doubled brace is never a placeholder and {{1} is written as it is.
+	*/
+	constexpr std::size_t invalid_placeholder_end(std::string_view fmt, std::size_t pos) noexcept{
+		std::size_t i = pos + 1;
+
+		while(i < fmt.size() && fmt[i] >= '0' && fmt[i] <= '9')
+			++i;
+
+		return i < fmt.size() && fmt[i] == '{' ? i + 1 : i;
+	}
+
+	/*
+	*	Format string that is split into text and placeholders once, at compile time if declared constexpr:
+	*		constexpr str::FormatString fmt{"{1} took {2}ms"};
+	*		str::format_append(line, fmt, name, duration);
+	*/
+	template<std::size_t N>
+	class FormatString{
+	public:
+		struct Segment{
+			std::size_t start = 0;
+			std::size_t length = 0;
+			std::size_t argument = 0; //Index of the argument to insert (starting at 1) or 0 for plain text
+		};
+
+		constexpr explicit FormatString(const char (&fmt)[N]) : fmt{fmt, N - 1}{
+			std::size_t textStart = 0;
+
+			for(std::size_t i = 0; i < this->fmt.size();){
+				std::size_t index = 0;
+				std::size_t end = this->fmt[i] == '{' ? parse_placeholder(this->fmt, i, index) : std::string_view::npos;
+
+				if(end == std::string_view::npos){
+					i = this->fmt[i] == '{' ? invalid_placeholder_end(this->fmt, i) : i + 1;
+
+					continue;
+				}
+
+				if(i > textStart)
+					segments[segmentCount++] = Segment{textStart, i - textStart, 0};
+
+				segments[segmentCount++] = Segment{i, end - i, index};
+				i = textStart = end;
+			}
+
+			if(textStart < this->fmt.size())
+				segments[segmentCount++] = Segment{textStart, this->fmt.size() - textStart, 0};
+		}
+
+		constexpr std::string_view str() const noexcept{ return fmt; }
+		constexpr const Segment* begin() const noexcept{ return segments.data(); }
+		constexpr const Segment* end() const noexcept{ return segments.data() + segmentCount; }
+
+	private:
+		std::string_view fmt;
+		std::array<Segment, N> segments{}; //A string of N - 1 characters can't have more than N segments
+		std::size_t segmentCount = 0;
+	};
+
+	/*
+	*	std::to_chars and std::from_chars for floating point types, a negative precision gives the shortest round trip representation.
+	*	Standard libraries that don't have them yet (no __cpp_lib_to_chars) fall back to std::snprintf and std::strtod,
+	*	these accept the same input and write values that read back the same but use the decimal point of the C locale.
+	*/
+	template<typename T>
+	std::from_chars_result float_from_chars(const char* first, const char* last, T& value){
+#if __cpp_lib_to_chars >= 201611L
+		return std::from_chars(first, last, value);
+#else
+		//std::strtod also skips whitespaces and accepts plus signs and hexadecimal numbers which std::from_chars doesn't
+		std::string_view s{first, static_cast<std::size_t>(last - first)};
+		std::size_t sign = !s.empty() && s[0] == '-' ? 1 : 0;
+
+		if(s.size() == sign || !(std::isalnum(static_cast<unsigned char>(s[sign])) || s[sign] == '.'))
+			return {first, std::errc::invalid_argument};
+
+		if(s.size() > sign + 1 && s[sign] == '0' && (s[sign + 1] == 'x' || s[sign + 1] == 'X'))
+			s = s.substr(0, sign + 1); //std::from_chars stops after the zero
+
+		std::string copy{s};
+		char* end;
+		T result;
+
+		errno = 0;
+
+		if constexpr(std::is_same_v<T, float>)
+			result = std::strtof(copy.c_str(), &end);
+		else if constexpr(std::is_same_v<T, double>)
+			result = std::strtod(copy.c_str(), &end);
+		else
+			result = std::strtold(copy.c_str(), &end);
+
+		if(end == copy.c_str())
+			return {first, std::errc::invalid_argument};
+
+		if(errno == ERANGE && (std::isinf(result) || result == 0)) //Also set for subnormal values which std::from_chars accepts
+			return {first + (end - copy.c_str()), std::errc::result_out_of_range};
+
+		value = result;
+
+		return {first + (end - copy.c_str()), std::errc{}};
+#endif
+	}
+
+	template<typename T>
+	std::to_chars_result float_to_chars(char* first, char* last, T value, int precision = -1){
+#if __cpp_lib_to_chars >= 201611L
+		if(precision < 0)
+			return std::to_chars(first, last, value);
+
+		return std::to_chars(first, last, value, std::chars_format::general, precision);
+#else
+		char buffer[64];
+		int size = 0;
+
+		if(precision >= 0 || !std::isfinite(value)){
+			size = std::snprintf(buffer, sizeof(buffer), "%.*Lg", precision < 0 ? 0 : precision, static_cast<long double>(value));
+		}else{
+			//%g drops trailing zeros so digits10 is already the shortest form for most values
+			for(int digits = std::numeric_limits<T>::digits10; digits <= std::numeric_limits<T>::max_digits10; ++digits){
+				T parsed;
+
+				size = std::snprintf(buffer, sizeof(buffer), "%.*Lg", digits, static_cast<long double>(value));
+
+				if(float_from_chars(buffer, buffer + size, parsed).ec == std::errc{} && parsed == value)
+					break;
+			}
+		}
+
+		if(size < 0 || size > last - first)
+			return {last, std::errc::value_too_large};
 
-	template<typename T, typename ... Args>
-	void to_string_vector(std::vector<std::string>& result, const T& t, Args ...args){
-		result.push_back(static_cast<std::ostringstream&&>((std::ostringstream{} << t)).str());
-		to_string_vector(result, args...);
+		return {std::copy(buffer, buffer + size, first), std::errc{}};
+#endif
+	}
+
+	/*
+	*	Writes a single formatting argument to sink without allocating for strings, characters and numbers.
+	*	Output matches what std::ostream would produce with default flags, other types are still formatted through a stream.
+	*/
+	template<typename Sink, typename T>
+	void format_argument(Sink& sink, const T& value){
+		if constexpr(std::is_same_v<T, bool>){
+			sink(value ? std::string_view{"1"} : std::string_view{"0"});
+		}else if constexpr(std::is_same_v<T, char> || std::is_same_v<T, signed char> || std::is_same_v<T, unsigned char>){
+			char c = static_cast<char>(value);
+
+			sink(std::string_view{&c, 1});
+		}else if constexpr(std::is_integral_v<T> && sizeof(T) <= sizeof(long long) && !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>){
+			char buffer[24];
+			auto result = std::to_chars(std::begin(buffer), std::end(buffer), value);
+
+			sink(std::string_view{buffer, static_cast<std::size_t>(result.ptr - buffer)});
+		}else if constexpr(std::is_floating_point_v<T>){
+			char buffer[64];
+			auto result = float_to_chars(std::begin(buffer), std::end(buffer), value, 6);
+
+			sink(std::string_view{buffer, static_cast<std::size_t>(result.ptr - buffer)});
+		}else if constexpr(std::is_convertible_v<const T&, std::string_view>){
+			sink(std::string_view{value});
+		}else{
+			std::ostringstream out;
+
+			out << value;
+			sink(std::string_view{out.str()});
+		}
+	}
+
+	//Writes argument number index (starting at 1), returns false if there is no such argument
+	template<typename Sink, typename ... Args>
+	bool format_argument_at(Sink& sink, std::size_t index, const Args& ...args){
+		std::size_t i = 0;
+
+		return ((++i == index ? (format_argument(sink, args), true) : false) || ...);
+	}
+
+	/*
+	*	Formatting into any sink, i.e. a callable taking std::string_view.
+	*	fmt is either a FormatString or anything convertible to std::string_view, which is then parsed on the fly.
+	*/
+	template<typename Sink, typename Format, typename ... Args>
+	void format_into(Sink&& sink, const Format& fmt, const Args& ...args){
+		if constexpr(std::is_convertible_v<const Format&, std::string_view>){
+			std::string_view s{fmt};
+
+			while(!s.empty()){
+				std::size_t index = 0;
+				std::size_t open = s.find('{');
+				std::size_t end = open == std::string_view::npos ? open : parse_placeholder(s, open, index);
+
+				if(end == std::string_view::npos){
+					std::size_t textEnd = open == std::string_view::npos ? s.size() : invalid_placeholder_end(s, open);
+
+					sink(s.substr(0, textEnd));
+					s.remove_prefix(textEnd);
+				}else{
+					if(open > 0)
+						sink(s.substr(0, open));
+
+					if(!format_argument_at(sink, index, args...))
+						sink(s.substr(open, end - open));
+
+					s.remove_prefix(end);
+				}
+			}
+		}else{
+			for(const auto& segment : fmt){
+				if(segment.argument == 0 || !format_argument_at(sink, segment.argument, args...))
+					sink(fmt.str().substr(segment.start, segment.length));
+			}
+		}
+	}
+
+	//Appends the formatted string to out
+	template<typename Format, typename ... Args>
+	void format_append(std::string& out, const Format& fmt, const Args& ...args){
+		format_into([&out](std::string_view s){ out.append(s); }, fmt, args...);
+	}
+
+	//Writes the formatted string to an output iterator and returns the iterator past the last character written
+	template<typename OutputIt, typename Format, typename ... Args>
+	OutputIt format_to(OutputIt out, const Format& fmt, const Args& ...args){
+		format_into([&out](std::string_view s){ out = std::copy(s.begin(), s.end(), out); }, fmt, args...);
+
+		return out;
+	}
+
+	/*
+	*	Writes at most size characters of the formatted string to buffer without null terminating it.
+	*	Returns the length of the whole formatted string which may be larger than size.
+	*/
+	template<typename Format, typename ... Args>
+	std::size_t format_to_n(char* buffer, std::size_t size, const Format& fmt, const Args& ...args){
+		std::size_t length = 0;
+
+		format_into([&](std::string_view s){
+			if(length < size)
+				s.copy(buffer + length, std::min(s.size(), size - length));
+
+			length += s.size();
+		}, fmt, args...);
+
+		return length;
 	}
 
 	/*
@@ -155,58 +830,147 @@ namespace util::str{
 	*	e.g. {1} would mean that the first parameter passed to the function will
 	*	be added at this position
 	*	One index can be used multiple times and the order is completely irrelevant
+	*	Placeholders without a matching argument and braces that don't form one are written as they are.
 	*/
-	template<typename ... Args>
-	std::string format(std::string_view fmt, Args&& ...args){
+	template<typename Format, typename ... Args>
+	std::string format(const Format& fmt, const Args& ...args){
 		std::string result;
-		std::vector<std::string> values;
-
-		result.reserve(fmt.size());
-		to_string_vector(values, args...);
-
-		for(std::size_t i = 0; i < fmt.size(); ++i){
-			if(fmt[i] == '{'){
-				char* end;
-				std::size_t index = std::strtoul(&fmt[i + 1], &end, 10);
-				std::size_t start = i;
-
-				while(&fmt[i] != end)
-					++i;
-
-				if(*end == '}' && index > 0 && index <= values.size())
-					result += values[index - 1];
-				else
-					result += std::string_view{&fmt[start], i - start + 1};
-			}else{
-				result.push_back(fmt[i]);
+
+		if constexpr(std::is_convertible_v<const Format&, std::string_view>)
+			result.reserve(std::string_view{fmt}.size());
+		else
+			result.reserve(fmt.str().size());
+
+		format_append(result, fmt, args...);
+
+		return result;
+	}
+
+	//Multiplies both values to 128 bits and folds the result back to 64
+	inline std::uint64_t multiply_mix(std::uint64_t a, std::uint64_t b) noexcept{
+#ifdef __SIZEOF_INT128__
+		__extension__ typedef unsigned __int128 UInt128; //__extension__ keeps -Wpedantic quiet about the non-standard type
+		UInt128 product = static_cast<UInt128>(a) * b;
+
+		return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+		std::uint64_t high;
+		std::uint64_t low = _umul128(a, b, &high);
+
+		return low ^ high;
+#else
+		std::uint64_t aLow = a & 0xFFFFFFFF, aHigh = a >> 32, bLow = b & 0xFFFFFFFF, bHigh = b >> 32;
+		std::uint64_t lowLow = aLow * bLow, lowHigh = aLow * bHigh, highLow = aHigh * bLow, highHigh = aHigh * bHigh;
+		std::uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFF) + (highLow & 0xFFFFFFFF);
+		std::uint64_t low = (lowLow & 0xFFFFFFFF) | (middle << 32);
+		std::uint64_t high = highHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+
+		return low ^ high;
+#endif
+	}
+
+	/*
+	*	Case insensitive wyhash style hash that can be fed in pieces, e.g. to skip characters without copying the rest.
+	*	Feeding a string in pieces gives the same result as feeding it at once.
+	*	ASCII letters are folded eight at a time while loading so nothing is allocated or copied.
+	*/
+	class CaseInsensitiveHasher{
+	public:
+		explicit CaseInsensitiveHasher(std::uint64_t seed = 0) noexcept : state{seed ^ secret[0]}{}
+
+		void update(std::string_view s) noexcept{
+			length += s.size();
+
+			if(bufferSize > 0){
+				std::size_t count = std::min(s.size(), sizeof(buffer) - bufferSize);
+
+				std::memcpy(buffer + bufferSize, s.data(), count);
+				bufferSize += count;
+				s.remove_prefix(count);
+
+				if(bufferSize < sizeof(buffer))
+					return;
+
+				consume(buffer);
+				bufferSize = 0;
 			}
+
+			for(; s.size() >= sizeof(buffer); s.remove_prefix(sizeof(buffer)))
+				consume(s.data());
+
+			std::memcpy(buffer, s.data(), s.size());
+			bufferSize = s.size();
 		}
 
-		return result;
+		std::uint64_t finish() const noexcept{
+			char tail[sizeof(buffer)] = {};
+
+			std::memcpy(tail, buffer, bufferSize);
+
+			std::uint64_t result = multiply_mix(load_folded(tail) ^ secret[1], load_folded(tail + 8) ^ state);
+
+			return multiply_mix(result ^ secret[2], length ^ secret[3]);
+		}
+
+	private:
+		static constexpr std::uint64_t secret[] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull};
+
+		std::uint64_t state;
+		std::uint64_t length = 0;
+		char buffer[16];
+		std::size_t bufferSize = 0;
+
+		//Sets the case bit of every byte between 'A' and 'Z'
+		static std::uint64_t load_folded(const char* s) noexcept{
+			constexpr std::uint64_t ones = 0x0101010101010101ull, highBits = ones * 0x80;
+			std::uint64_t word;
+
+			std::memcpy(&word, s, sizeof(word));
+
+			std::uint64_t low = word & ~highBits;
+			std::uint64_t atLeastA = low + ones * (0x80 - 'A');
+			std::uint64_t aboveZ = low + ones * (0x80 - 'Z' - 1);
+
+			return word | ((atLeastA & ~aboveZ & ~word & highBits) >> 2);
+		}
+
+		void consume(const char* s) noexcept{
+			state = multiply_mix(load_folded(s) ^ secret[1], load_folded(s + 8) ^ state);
+		}
+	};
+
+	inline std::uint64_t hash_ignore_case(std::string_view s, std::uint64_t seed = 0) noexcept{
+		CaseInsensitiveHasher hasher{seed};
+
+		hasher.update(s);
+
+		return hasher.finish();
 	}
 
 	//Case insensitive hash
 	struct CaseInsensitiveHash{
-		std::size_t operator()(std::string_view s) const{
-			return std::hash<std::string>{}(to_lower(s));
+		using is_transparent = void;
+
+		std::size_t operator()(std::string_view s) const noexcept{
+			return static_cast<std::size_t>(hash_ignore_case(s));
 		}
 	};
 
 	//Case insensitive comparison
 	struct CaseInsensitiveEqual{
+		using is_transparent = void;
+
 		bool operator()(std::string_view s1, std::string_view s2) const noexcept{
-			return std::equal(s1.begin(), s1.end(), s2.begin(), s2.end(), [](char a, char b){
-				return std::tolower(a) == std::tolower(b);
-			});
+			return equals_ignore_case(s1, s2);
 		}
 	};
 
 	//Case insensitive less for ordered containers
 	struct CaseInsensitiveLess{
+		using is_transparent = void;
+
 		bool operator()(std::string_view s1, std::string_view s2) const noexcept{
-			return std::lexicographical_compare(s1.begin(), s1.end(), s2.begin(), s2.end(), [](char a, char b){
-				return std::tolower(a) < std::tolower(b);
-			});
+			return compare_ignore_case(s1, s2) < 0;
 		}
 	};
 }
@@ -1,107 +1,241 @@
 #pragma once
 
 namespace util::str{
+	template<typename T>
+	struct IsDuration : std::false_type{};
+
+	template<typename Rep, typename Period>
+	struct IsDuration<std::chrono::duration<Rep, Period>> : std::true_type{};
+
 	//to_string
 
 	template<typename T>
-	std::string to_string(T value){
-		return std::to_string(value);
+	std::to_chars_result to_chars(char* first, char* last, const T& value){
+		auto copy = [last](char* out, std::string_view s) -> std::to_chars_result{
+			if(s.size() > static_cast<std::size_t>(last - out))
+				return {last, std::errc::value_too_large};
+
+			return {std::copy(s.begin(), s.end(), out), std::errc{}};
+		};
+
+		if constexpr(std::is_same_v<T, bool>){
+			return copy(first, value ? "true" : "false");
+		}else if constexpr(std::is_same_v<T, char>){
+			return copy(first, {&value, 1});
+		}else if constexpr(std::is_enum_v<T>){
+			return std::to_chars(first, last, static_cast<std::underlying_type_t<T>>(value));
+		}else if constexpr(std::is_floating_point_v<T>){
+			return float_to_chars(first, last, value); //Shortest round trip representation
+		}else if constexpr(std::is_arithmetic_v<T>){
+			return std::to_chars(first, last, value);
+		}else if constexpr(IsDuration<T>{}){
+			using Period = typename T::period;
+
+			auto result = to_chars(first, last, value.count());
+			std::string_view unit;
+
+			if constexpr(std::is_same_v<Period, std::nano>)
+				unit = "ns";
+			else if constexpr(std::is_same_v<Period, std::micro>)
+				unit = "us";
+			else if constexpr(std::is_same_v<Period, std::milli>)
+				unit = "ms";
+			else if constexpr(std::is_same_v<Period, std::ratio<1>>)
+				unit = "s";
+			else if constexpr(std::is_same_v<Period, std::ratio<60>>)
+				unit = "min";
+			else if constexpr(std::is_same_v<Period, std::ratio<3600>>)
+				unit = "h";
+			else if constexpr(std::is_same_v<Period, std::ratio<86400>>)
+				unit = "d"; //Other periods are written without unit which from_string reads as a count in T's period
+
+			return result.ec == std::errc{} ? copy(result.ptr, unit) : result;
+		}else{
+			static_assert(std::is_convertible_v<const T&, std::string_view>, "to_chars: Unsupported type");
+
+			return copy(first, value);
+		}
 	}
 
-	template<>
-	inline std::string to_string<bool>(bool value){
-		return value ? "true" : "false";
+	template<typename T>
+	void append_string(std::string& s, const T& value){
+		if constexpr(std::is_convertible_v<const T&, std::string_view> && !std::is_same_v<T, char>){
+			s += std::string_view{value};
+		}else{
+			char buffer[64]; //Enough for the longest long double and a duration unit
+			auto result = to_chars(buffer, buffer + sizeof(buffer), value);
+
+			s.append(buffer, result.ptr);
+		}
 	}
 
-	template<>
-	inline std::string to_string<char>(char value){
-		std::string temp;
+	template<typename T>
+	std::string to_string(T value){
+		std::string result;
 
-		temp += value;
+		append_string(result, value);
 
-		return temp;
+		return result;
 	}
 
-	//to_value
+	//from_string
 
-	template<>
-	inline bool to_value<bool>(const std::string& value){
-		std::string lower = to_lower(value);
+	template<typename T>
+	std::errc from_string(std::string_view s, T& value){
+		if constexpr(std::is_same_v<T, bool>){
+			if(equals_ignore_case(s, "true") || s == "1")
+				value = true;
+			else if(equals_ignore_case(s, "false") || s == "0")
+				value = false;
+			else
+				return std::errc::invalid_argument;
 
-		if(lower == "true")
-			return true;
+			return {};
+		}else if constexpr(std::is_same_v<T, char>){
+			//The character itself, just like to_chars writes it
+			if(s.size() != 1)
+				return std::errc::invalid_argument;
 
-		if(lower == "false")
-			return false;
+			value = s[0];
 
-		if(lower == "0")
-			return false;
+			return {};
+		}else if constexpr(std::is_enum_v<T>){
+			std::underlying_type_t<T> result;
+			std::errc error = from_string(s, result);
 
-		return true;
-	}
+			if(error == std::errc{})
+				value = static_cast<T>(result);
 
-	template<>
-	inline signed char to_value<signed char>(const std::string& value){
-		return static_cast<signed char>(std::stoi(value));
-	}
+			return error;
+		}else if constexpr(std::is_arithmetic_v<T>){
+			if(s.size() > 1 && s[0] == '+' && s[1] != '-') //std::from_chars doesn't accept a plus sign
+				s.remove_prefix(1);
 
-	template<>
-	inline unsigned char to_value<unsigned char>(const std::string& value){
-		return static_cast<unsigned char>(std::stoi(value));
-	}
+			T result;
+			std::from_chars_result parsed;
 
-	template<>
-	inline short to_value<short>(const std::string& value){
-		return static_cast<short>(std::stoi(value));
-	}
+			if constexpr(std::is_floating_point_v<T>)
+				parsed = float_from_chars(s.data(), s.data() + s.size(), result);
+			else
+				parsed = std::from_chars(s.data(), s.data() + s.size(), result);
 
-	template<>
-	inline unsigned short to_value<unsigned short>(const std::string& value){
-		return static_cast<unsigned short>(std::stoul(value));
-	}
+			auto [end, error] = parsed;
 
-	template<>
-	inline int to_value<int>(const std::string& value){
-		return std::stoi(value);
-	}
+			if(error != std::errc{})
+				return error;
 
-	template<>
-	inline unsigned int to_value<unsigned int>(const std::string& value){
-		return std::stoul(value);
-	}
+			if(end != s.data() + s.size())
+				return std::errc::invalid_argument;
 
-	template<>
-	inline long to_value<long>(const std::string& value){
-		return std::stol(value);
-	}
+			value = result;
 
-	template<>
-	inline unsigned long to_value<unsigned long>(const std::string& value){
-		return std::stol(value);
-	}
+			return {};
+		}else if constexpr(IsDuration<T>{}){
+			//A number followed by one of the units below, numbers without unit are counted in T's period
+			constexpr std::pair<std::string_view, double> units[] = {{"ns", 1e-9}, {"us", 1e-6}, {"ms", 1e-3}, {"s", 1.0}, {"min", 60.0}, {"m", 60.0}, {"h", 3600.0}, {"d", 86400.0}};
+			double count;
+			auto [end, error] = float_from_chars(s.data(), s.data() + s.size(), count);
 
-	template<>
-	inline long long to_value<long long>(const std::string& value){
-		return std::stoll(value);
-	}
+			if(error != std::errc{})
+				return error;
+
+			if(!std::isfinite(count))
+				return std::errc::invalid_argument;
+
+			std::string_view unit{end, static_cast<std::size_t>(s.data() + s.size() - end)};
+			std::chrono::duration<double> seconds = std::chrono::duration<double, typename T::period>{count};
+
+			if(!unit.empty()){
+				auto it = std::find_if(std::begin(units), std::end(units), [unit](const auto& u){ return u.first == unit; });
+
+				if(it == std::end(units))
+					return std::errc::invalid_argument;
+
+				seconds = std::chrono::duration<double>{count * it->second};
+			}
 
-	template<>
-	inline unsigned long long to_value<unsigned long long>(const std::string& value){
-		return std::stoull(value);
+			using Rep = typename T::rep;
+
+			//Rounded to the nearest count, which also absorbs the error of going through seconds, e.g. 3ns being 2.9999999999999996ns
+			double result = std::chrono::duration<double, typename T::period>{seconds}.count();
+
+			if constexpr(!std::chrono::treat_as_floating_point_v<Rep>)
+				result = std::round(result);
+
+			//The largest integer plus one is exactly representable as a double while the largest integer itself might not be
+			if(!std::isfinite(result) || std::abs(result) >= static_cast<double>(std::numeric_limits<Rep>::max()) + 1.0)
+				return std::errc::result_out_of_range;
+
+			value = T{static_cast<Rep>(result)};
+
+			return {};
+		}else{
+			value = T{s};
+
+			return {};
+		}
 	}
 
-	template<>
-	inline float to_value<float>(const std::string& value){
-		return std::stof(value);
+	template<typename T>
+	ParseResult<T> parse_value(std::string_view s){
+		auto isSpace = [](char c){ return c == ' ' || (c >= '\t' && c <= '\r'); };
+
+		if constexpr(std::is_same_v<T, char>){
+			if(s.size() == 1) //A single whitespace is a valid char
+				return ParseResult<T>{s[0], std::errc{}};
+		}
+
+		while(!s.empty() && isSpace(s.front()))
+			s.remove_prefix(1);
+
+		while(!s.empty() && isSpace(s.back()))
+			s.remove_suffix(1);
+
+		ParseResult<T> result;
+
+		result.error = from_string(s, result.value);
+
+		return result;
 	}
 
-	template<>
-	inline double to_value<double>(const std::string& value){
-		return std::stod(value);
+	//to_value
+
+	template<typename T>
+	T to_value(const std::string& value){
+		ParseResult<T> result = parse_value<T>(value);
+
+		if(result.error == std::errc::result_out_of_range)
+			throw std::out_of_range{"to_value: Value out of range"};
+
+		if(result.error != std::errc{})
+			throw std::invalid_argument{"to_value: Invalid value"};
+
+		return std::move(result.value);
 	}
 
-	template<>
-	inline long double to_value<long double>(const std::string& value){
-		return std::stold(value);
+	inline std::errc parse_byte_size(std::string_view s, std::uint64_t& bytes){
+		constexpr std::pair<std::string_view, std::uint64_t> units[] = {{"", 1}, {"B", 1},
+																		{"K", 1ull << 10}, {"KiB", 1ull << 10}, {"KB", 1000ull},
+																		{"M", 1ull << 20}, {"MiB", 1ull << 20}, {"MB", 1000000ull},
+																		{"G", 1ull << 30}, {"GiB", 1ull << 30}, {"GB", 1000000000ull},
+																		{"T", 1ull << 40}, {"TiB", 1ull << 40}, {"TB", 1000000000000ull}};
+		std::uint64_t count;
+		auto [end, error] = std::from_chars(s.data(), s.data() + s.size(), count);
+
+		if(error != std::errc{})
+			return error;
+
+		std::string_view unit{end, static_cast<std::size_t>(s.data() + s.size() - end)};
+		auto it = std::find_if(std::begin(units), std::end(units), [unit](const auto& u){ return u.first == unit; });
+
+		if(it == std::end(units))
+			return std::errc::invalid_argument;
+
+		if(count > std::numeric_limits<std::uint64_t>::max() / it->second)
+			return std::errc::result_out_of_range;
+
+		bytes = count * it->second;
+
+		return {};
 	}
 }
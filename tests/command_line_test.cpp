@@ -0,0 +1,170 @@
+/*
+*	Checks how CommandLine and OptionSchema split arguments into options and values.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <string_view>
+#include "commandLine.h"
+
+namespace{
+	using util::CommandLine;
+	using util::OptionError;
+
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	bool same(const std::vector<std::string_view>& values, std::initializer_list<std::string_view> expected){
+		return std::equal(values.begin(), values.end(), expected.begin(), expected.end());
+	}
+
+	//-x, --x and --x=v are the same option, looked up with or without dashes
+	void test_option_forms(){
+		CommandLine cmd{"prog -a 1 --b 2 --c=3 -d=4 --e= -f"};
+
+		for(std::string_view name : {"a", "-a", "--a"})
+			CHECK(cmd.has_option(name) && cmd.value_for_option(name) == "1");
+
+		CHECK(cmd.value_for_option("-b") == "2" && cmd.value_for_option("b") == "2");
+		CHECK(cmd.value_for_option("--c") == "3" && cmd.value_for_option("d") == "4");
+		CHECK(cmd.has_option("e") && cmd.value_for_option("e").empty());
+		CHECK(cmd.has_option("-f") && cmd.value_for_option<bool>("f").value);
+		CHECK(!cmd.has_option("g") && !cmd.has_option("c=3"));
+		CHECK(same(cmd.values_without_option(), {"prog"}));
+
+		//An attached value doesn't take the next argument
+		CommandLine attached{"--name=x y"};
+
+		CHECK(attached.value_for_option("name") == "x" && same(attached.values_without_option(), {"y"}));
+
+		//Options that follow an option are not its value
+		CommandLine flags{"-a -b value"};
+
+		CHECK(flags.has_option("a") && flags.value_for_option("a").empty() && flags.value_for_option("b") == "value");
+		CHECK(flags.value_for_option<int>("a").error == OptionError::Missing);
+	}
+
+	//Negative numbers are values, whether an option is waiting for one or not
+	void test_negative_numbers(){
+		CommandLine cmd{"-x -1 -y -.5 -2 --z=-3 -5e3"};
+
+		CHECK(cmd.value_for_option<int>("x").value == -1);
+		CHECK(cmd.value_for_option<double>("y").value == -0.5);
+		CHECK(cmd.value_for_option<int>("z").value == -3);
+		CHECK(same(cmd.values_without_option(), {"-2", "-5e3"}));
+		CHECK(!cmd.has_option("1") && !cmd.has_option("2") && !cmd.has_option(".5"));
+
+		CommandLine leading{"-7 -n -"};
+
+		CHECK(same(leading.values_without_option(), {"-7"}) && leading.value_for_option("n") == "-");
+	}
+
+	void test_repeated_options(){
+		CommandLine cmd{"-i 1 --i 2 -i=3,4 file"};
+
+		CHECK(cmd.value_for_option("i") == "3,4");
+		CHECK(same(cmd.values_for_option("-i"), {"1", "2", "3,4"}));
+		CHECK(cmd.list_for_option<int>("--i").value == std::vector<int>{1, 2, 3, 4});
+		CHECK(same(cmd.values_without_option(), {"file"}));
+		CHECK(cmd.str() == "-i 1 --i 2 -i=3,4 file");
+	}
+
+	constexpr util::OptionSchema schema{util::Option{"threads", 4}, util::Option{"verbose", false}, util::Option{"out", "a.txt"}, util::Option{"scale", 1.0}};
+
+	static_assert(schema.index_of("threads") == 0 && schema.index_of("out") == 2 && schema.index_of("scale") == 3);
+	static_assert(schema.index_of("missing") == schema.npos && schema.index_of("") == schema.npos && schema.index_of("-threads") == schema.npos);
+	static_assert(schema.name_of(3) == "scale");
+
+	template<std::size_t N>
+	auto parse(const char* const (&argv)[N]){
+		return schema.parse(static_cast<int>(N), argv);
+	}
+
+	void test_schema_defaults(){
+		const char* const argv[] = {"prog"};
+		auto options = parse(argv);
+
+		CHECK(options.valid());
+		CHECK(options.get<schema.index_of("threads")>() == 4 && !options.get<schema.index_of("verbose")>());
+		CHECK(options.get<schema.index_of("out")>() == "a.txt" && options.get<schema.index_of("scale")>() == 1.0);
+		CHECK(!options.has<0>() && !options.has<1>() && !options.has<2>() && !options.has<3>());
+
+		//Types that aren't literal types make the schema a runtime object
+		const util::OptionSchema stringSchema{util::Option{"name", std::string{"default"}}};
+		const char* const name[] = {"prog", "--name=x=y"};
+
+		CHECK(stringSchema.parse(1, name).get<0>() == "default" && stringSchema.parse(2, name).get<0>() == "x=y");
+	}
+
+	//--opt=value, --opt value and -opt value are the same, the last occurrence wins
+	void test_schema_forms(){
+		const char* const argv[] = {"prog", "--threads=8", "-out", "b.txt", "--scale", "-.5", "positional", "--threads", "16"};
+		auto options = parse(argv);
+
+		CHECK(options.valid());
+		CHECK(options.get<0>() == 16 && options.has<0>());
+		CHECK(options.get<2>() == "b.txt" && options.get<3>() == -0.5);
+		CHECK(!options.has<1>());
+
+		//Flags don't take the next argument, but accept an attached value
+		const char* const flags[] = {"prog", "--verbose", "file", "--threads", "-3"};
+		auto flagOptions = parse(flags);
+
+		CHECK(flagOptions.get<1>() && flagOptions.has<1>() && flagOptions.get<0>() == -3);
+
+		const char* const attached[] = {"prog", "--verbose=false"};
+
+		CHECK(!parse(attached).get<1>() && parse(attached).has<1>());
+	}
+
+	void test_schema_errors(){
+		//Unknown options are skipped together with their value
+		const char* const unknown[] = {"prog", "--unknown", "value", "--other=1", "--threads", "2"};
+		auto options = parse(unknown);
+
+		CHECK(options.valid() && options.get<0>() == 2);
+
+		//A missing value keeps the default, a following option isn't taken as the value
+		const char* const missing[] = {"prog", "--threads", "--out", "c.txt", "--scale"};
+		auto missingOptions = parse(missing);
+
+		CHECK(missingOptions.valid() && missingOptions.has<0>() && missingOptions.get<0>() == 4);
+		CHECK(missingOptions.get<2>() == "c.txt" && missingOptions.has<3>() && missingOptions.get<3>() == 1.0);
+
+		//Values that don't convert are reported and leave the default in place
+		const char* const invalid[] = {"prog", "--threads=many", "--scale=1e999", "--verbose=maybe"};
+		auto invalidOptions = parse(invalid);
+
+		CHECK(!invalidOptions.valid() && invalidOptions.invalid_option() == "threads");
+		CHECK(invalidOptions.get<0>() == 4 && invalidOptions.get<3>() == 1.0 && !invalidOptions.get<1>());
+
+		const char* const empty[] = {"prog", "--threads="};
+
+		CHECK(parse(empty).invalid_option() == "threads");
+	}
+}
+
+int main(){
+	test_option_forms();
+	test_negative_numbers();
+	test_repeated_options();
+	test_schema_defaults();
+	test_schema_forms();
+	test_schema_errors();
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
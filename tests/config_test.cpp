@@ -0,0 +1,434 @@
+/*
+*	Checks loading, changing and saving a Config, its handles, typed value cache and binary cache as well as LayeredConfig.
+*	Works on files in a temporary directory that is removed afterwards.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iterator>
+#include <filesystem>
+#include "config.h"
+#include "layeredConfig.h"
+
+namespace{
+	using util::Config;
+	using util::LayeredConfig;
+
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	std::filesystem::path directory;
+
+	std::string file_path(const std::string& name){
+		return (directory / name).string();
+	}
+
+	void write_file(const std::string& fileName, const std::string& contents){
+		std::ofstream{fileName, std::ios::binary} << contents;
+	}
+
+	std::string read_file(const std::string& fileName){
+		std::ifstream in{fileName, std::ios::binary};
+
+		return {std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+	}
+
+	//Handles refer to the same key while the index grows around them
+	void test_handles(){
+		Config config;
+		Config::Handle first = config.handle_for("Section", "first", "1");
+		std::vector<Config::Handle> handles;
+
+		for(int i = 0; i < 1000; ++i)
+			handles.push_back(config.handle_for("Section" + std::to_string(i % 7), "key" + std::to_string(i), std::to_string(i)));
+
+		bool same = true;
+
+		for(int i = 0; i < 1000; ++i){
+			same &= config.get(handles[static_cast<std::size_t>(i)]) == std::to_string(i);
+			same &= config.find("section" + std::to_string(i % 7), "KEY" + std::to_string(i)).valid();
+		}
+
+		CHECK(same);
+		CHECK(config.get(first) == "1" && config.handle_for("section", "FIRST", "2").valid());
+
+		config.set(first, "one");
+		CHECK(config.get("Section", "first", "") == "one");
+
+		config.set("SECTION", "first", "uno");
+		CHECK(config.get(first) == "uno");
+
+		//Merging another file into the config adds keys without moving the existing ones
+		std::string fileName = file_path("merge.ini");
+
+		write_file(fileName, "[Section]\nfirst=merged\nsecond=2\n");
+		CHECK(config.load_from_file(fileName, false));
+		CHECK(config.get(first) == "merged" && config.get(handles[999]) == "999" && config.get<int>("Section", "second", 0) == 2);
+
+		CHECK(!config.find("Section", "missing").valid() && !Config::Handle{}.valid());
+
+		config.clear();
+		CHECK(!config.find("Section", "first"));
+	}
+
+	//Sections and keys differing only in case or whitespace are the same, anything else must not collide
+	void test_case_insensitive_keys(){
+		Config config;
+
+		config.set("Graphics", "Anti Aliasing", "4");
+		CHECK(config.get("GRAPHICS", "antialiasing", "") == "4");
+		CHECK(config.get("graphics", " ANTI\tALIASING ", "") == "4");
+		CHECK(config.find("Graphic", "AntiAliasing").valid() == false);
+		CHECK(config.find("Graphics", "AntiAliasin").valid() == false);
+
+		config.set("graphics", "ANTIALIASING", "8");
+		CHECK(config.get<int>("Graphics", "AntiAliasing", 0) == 8);
+
+		//The same key in different sections and keys that are prefixes of each other stay apart
+		std::mt19937 rng{7};
+		std::vector<std::string> names;
+
+		for(int i = 0; i < 500; ++i){
+			std::string name;
+
+			for(int length = 1 + static_cast<int>(rng() % 6); length > 0; --length)
+				name += static_cast<char>((rng() % 2 ? 'a' : 'A') + static_cast<int>(rng() % 3)); //Few letters so that names repeat in different case
+
+			names.push_back(name);
+		}
+
+		Config many;
+		std::vector<std::pair<std::string, std::string>> reference;
+
+		for(std::size_t i = 0; i < names.size(); ++i){
+			std::string section = names[(i * 7) % names.size()];
+			std::string value = std::to_string(i);
+
+			many.set(section, names[i], value);
+
+			bool found = false;
+
+			for(auto& [key, stored] : reference){
+				if(util::str::equals_ignore_case(key, section + '\n' + names[i])){
+					stored = value;
+					found = true;
+				}
+			}
+
+			if(!found)
+				reference.emplace_back(section + '\n' + names[i], value);
+		}
+
+		bool same = true;
+
+		for(const auto& [key, value] : reference){
+			std::size_t split = key.find('\n');
+
+			same &= many.get(util::str::to_upper(key.substr(0, split)), util::str::to_lower(key.substr(split + 1)), "") == value;
+		}
+
+		CHECK(same);
+	}
+
+	//Both loaders read the same entries, the mapped one without copying them
+	void test_mapped_load(){
+		std::string fileName = file_path("load.ini");
+
+		write_file(fileName, "ignored=before any section\n"
+							 "[Section]\n"
+							 "; comment=not a key\n"
+							 "plain=value\n"
+							 "with spaces = padded value\n"
+							 "equals=a=b\n"
+							 "empty=\n"
+							 "no value\n"
+							 "repeated=1\n"
+							 "repeated=2\n"
+							 "\n"
+							 "[Other Section]\n"
+							 "plain=other");
+
+		Config streamed, mapped;
+
+		CHECK(streamed.load_from_file(fileName, true) && mapped.load_from_mapped_file(fileName, true));
+
+		std::ostringstream streamedDump, mappedDump;
+
+		streamed.dump(streamedDump);
+		mapped.dump(mappedDump);
+		CHECK(streamedDump.str() == mappedDump.str());
+
+		for(const Config* config : {&streamed, &mapped}){
+			CHECK(config->get("Section", "plain", "") == "value" && config->get("Other Section", "plain", "") == "other");
+			CHECK(config->get("Section", "withspaces", "") == " padded value" && config->get("Section", "equals", "") == "a=b");
+			CHECK(config->find("Section", "empty") && config->get("Section", "empty", "x").empty());
+			CHECK(config->get("Section", "novalue", "x").empty() && config->get<int>("Section", "repeated", 0) == 2);
+			CHECK(!config->find("Section", ";comment") && !config->find("", "ignored"));
+		}
+
+		//Copies share the mapping and keep it alive
+		Config copy = mapped;
+
+		mapped.clear();
+		CHECK(copy.get("Section", "equals", "") == "a=b");
+
+		copy.set("Section", "plain", "changed");
+		CHECK(copy.get("Section", "plain", "") == "changed" && copy.get("Other Section", "plain", "") == "other");
+
+		CHECK(!Config{}.load_from_mapped_file(file_path("missing.ini"), true));
+	}
+
+	//Typed reads are cached until the value changes, whichever way it changes
+	void test_typed_cache(){
+		Config config;
+		Config::Handle handle = config.handle_for("Section", "value", "5");
+
+		CHECK(config.get<int>(handle, 0) == 5 && config.get<int>(handle, 0) == 5);
+		CHECK(config.get<double>(handle, 0.0) == 5.0 && config.get<int>(handle, 0) == 5); //Switching types
+
+		config.set(handle, "7");
+		CHECK(config.get<int>(handle, 0) == 7);
+
+		config.set("Section", "value", 9);
+		CHECK(config.get<int>("Section", "value", 0) == 9 && config.get<int>(handle, 0) == 9);
+
+		config.set("Section", "value", "not a number");
+		CHECK(config.get<int>(handle, -1) == -1 && config.get<int>(handle, -2) == -2); //Invalid values are cached as invalid, not as a default
+
+		config.set("Section", "value", 2.5);
+		CHECK(config.get<double>(handle, 0.0) == 2.5 && config.get<float>(handle, 0.0f) == 2.5f);
+
+		//Reloading replaces the cached value
+		std::string fileName = file_path("typed.ini");
+
+		write_file(fileName, "[Section]\nvalue=11\n");
+		config.load_from_file(fileName, false);
+		CHECK(config.get<int>(handle, 0) == 11);
+
+		//Const reads fill the cache of an unchanged copy without touching the original
+		const Config copy = config;
+
+		CHECK(copy.get<int>("Section", "value", 0) == 11 && copy.get<int>("Section", "value", 0) == 11);
+
+		config.set(handle, "12");
+		CHECK(copy.get<int>("Section", "value", 0) == 11 && config.get<int>(handle, 0) == 12);
+
+		//Missing keys are added with the default by non-const reads only
+		CHECK(config.get<int>("Section", "added", 3) == 3 && config.get("Section", "added", "") == "3");
+		CHECK(copy.get<int>("Section", "missing", 4) == 4 && !copy.find("Section", "missing"));
+	}
+
+	//Only changed keys are written, everything else in the file stays where it was
+	void test_save_changes(){
+		const std::string original = "; Leading comment\n"
+									 "[Window]\n"
+									 "width=800\n"
+									 "; Height in pixels\n"
+									 "height=600\n"
+									 "\n"
+									 "[Audio]\n"
+									 "volume=0.5\n"
+									 "muted=false\n";
+		const std::string expected = "; Leading comment\n"
+									 "[Window]\n"
+									 "width=1024\n"
+									 "; Height in pixels\n"
+									 "height=600\n"
+									 "title=Demo\n"
+									 "\n"
+									 "[Audio]\n"
+									 "volume=0.5\n"
+									 "muted=true\n"
+									 "\n"
+									 "[Input]\n"
+									 "sensitivity=2\n";
+
+		for(bool mapped : {false, true}){
+			std::string fileName = file_path(mapped ? "mapped.ini" : "stream.ini");
+			Config config;
+
+			write_file(fileName, original);
+			CHECK(mapped ? config.load_from_mapped_file(fileName, true) : config.load_from_file(fileName, true));
+			CHECK(config.save_to_file(fileName) && read_file(fileName) == original); //Nothing changed
+
+			config.set("window", "WIDTH", 1024); //Case insensitive, the stored spelling is kept
+			config.set("Window", "title", "Demo");
+			config.set("Audio", "muted", true);
+			config.set("Input", "sensitivity", 2);
+			config.set("Audio", "volume", "0.5"); //Same value, still written as it was
+
+			CHECK(config.save_to_file(fileName));
+			CHECK(read_file(fileName) == expected);
+
+			//Saving again only writes new changes and the file reads back the same
+			config.set("Window", "height", 720);
+			CHECK(config.save_to_file(fileName));
+
+			Config reloaded{fileName};
+
+			CHECK(reloaded.get<int>("Window", "width", 0) == 1024 && reloaded.get<int>("Window", "height", 0) == 720);
+			CHECK(reloaded.get("Window", "title", "") == "Demo" && reloaded.get<bool>("Audio", "muted", false));
+			CHECK(read_file(fileName).find("; Height in pixels\nheight=720\n") != std::string::npos);
+		}
+
+		//A different file gets everything
+		Config config;
+		std::string fileName = file_path("copy.ini");
+
+		config.set("A", "key", 1);
+		CHECK(config.save_to_file(fileName) && Config{fileName}.get<int>("A", "key", 0) == 1);
+	}
+
+	bool cache_matches(const Config& config){
+		return config.get<int>("A", "first", 0) == 1 && config.get("A", "text", "") == "hello world" && config.get<double>("B", "second", 0.0) == 2.5;
+	}
+
+	//A valid cache is mapped as it is, a stale or corrupt one is ignored and rewritten from the source
+	void test_binary_cache(){
+		std::string source = file_path("cached.ini");
+		std::string cache = file_path("cached.cache");
+
+		write_file(source, "[A]\nfirst=1\ntext=hello world\n[B]\nsecond=2.5\n");
+
+		Config config{source};
+
+		CHECK(config.save_to_cache(cache, source));
+
+		std::string valid = read_file(cache);
+		Config mapped;
+
+		CHECK(mapped.load_from_cache(cache, source) && cache_matches(mapped));
+		CHECK(read_file(cache) == valid);
+
+		mapped.set("A", "first", 3); //Mapped values are copied when changed
+		CHECK(mapped.get<int>("A", "first", 0) == 3 && mapped.get("A", "text", "") == "hello world");
+
+		//Corrupt caches, read_file shows whether the cache was used or rewritten
+		auto corrupt = [&](std::size_t offset, const void* data, std::size_t size){
+			std::string contents = valid;
+
+			std::memcpy(&contents[offset], data, size);
+			write_file(cache, contents);
+
+			Config loaded;
+			bool loadedSource = loaded.load_from_cache(cache, source) && cache_matches(loaded);
+
+			return loadedSource && read_file(cache) == valid;
+		};
+
+		constexpr std::size_t headerSize = 40;
+		constexpr std::size_t entrySize = 24;
+		std::uint32_t hugeCount = 0x80000001; //Twice this wraps around to 2 in 32 bits
+		std::uint64_t hugeIndex = std::uint64_t{1} << 40;
+		std::uint32_t badOffset = 1 << 30;
+		std::uint32_t badSize = static_cast<std::uint32_t>(valid.size());
+		std::uint32_t version = 0;
+
+		CHECK(corrupt(0, "XXXX", 4));
+		CHECK(corrupt(8, &version, sizeof(version)));
+		CHECK(corrupt(12, &hugeCount, sizeof(hugeCount)));
+		CHECK(corrupt(16, &hugeIndex, sizeof(hugeIndex)));
+		CHECK(corrupt(headerSize + 2 * entrySize + 16, &badOffset, sizeof(badOffset))); //Value offset of the last entry
+		CHECK(corrupt(headerSize + entrySize + 12, &badSize, sizeof(badSize))); //Key size of the second entry
+
+		//Truncated files
+		write_file(cache, valid.substr(0, headerSize - 1));
+		CHECK(Config{}.load_from_cache(cache, source) && read_file(cache) == valid);
+
+		write_file(cache, valid.substr(0, valid.size() - 4));
+		CHECK(Config{}.load_from_cache(cache, source) && read_file(cache) == valid);
+
+		//A changed source makes the cache stale
+		write_file(source, "[A]\nfirst=10\n");
+
+		Config stale;
+
+		CHECK(stale.load_from_cache(cache, source) && stale.get<int>("A", "first", 0) == 10 && !stale.find("B", "second"));
+		CHECK(read_file(cache) != valid);
+
+		Config fresh;
+
+		CHECK(fresh.load_from_cache(cache, source) && fresh.get<int>("A", "first", 0) == 10);
+
+		std::filesystem::remove(source);
+		CHECK(!Config{}.load_from_cache(cache, source));
+	}
+
+	//Higher layers override lower ones key by key
+	void test_layered(){
+		auto layer = [](std::initializer_list<std::pair<const char*, const char*>> values){
+			auto config = std::make_shared<Config>();
+
+			for(const auto& [key, value] : values)
+				config->set("Section", key, value);
+
+			return std::shared_ptr<const Config>{config};
+		};
+
+		auto defaults = layer({{"a", "1"}, {"b", "1"}, {"c", "1"}});
+		auto user = layer({{"B", "2"}, {"c", "2"}});
+		auto overrides = layer({{"c", "3"}, {"d", "3"}});
+		LayeredConfig config{{defaults, user}};
+
+		CHECK(config.get<int>("Section", "a", 0) == 1 && config.get<int>("section", "b", 0) == 2 && config.get<int>("Section", "C", 0) == 2);
+		CHECK(config.layer_of("Section", "a") == 0 && config.layer_of("Section", "b") == 1 && config.layer_of("Section", "d") == LayeredConfig::npos);
+
+		config.push_layer(overrides);
+		CHECK(config.get<int>("Section", "c", 0) == 3 && config.get("Section", "d", "") == "3" && config.layer_of("Section", "c") == 2);
+
+		//Inserting below keeps the higher layers on top
+		auto base = layer({{"a", "0"}, {"e", "0"}});
+
+		config.insert_layer(0, base);
+		CHECK(config.get<int>("Section", "a", -1) == 1 && config.get<int>("Section", "e", -1) == 0 && config.layer_of("Section", "c") == 3);
+
+		config.insert_layer(100, layer({{"a", "4"}})); //Priorities above the top are clamped
+		CHECK(config.get<int>("Section", "a", 0) == 4 && config.layers().size() == 5);
+
+		CHECK(config.remove_layer(user) && !config.remove_layer(user));
+		CHECK(config.get<int>("Section", "b", 0) == 1 && config.get<int>("Section", "c", 0) == 3);
+
+		Config flat = config.flatten();
+
+		CHECK(flat.get<int>("Section", "a", 0) == 4 && flat.get<int>("Section", "b", 0) == 1 && flat.get<int>("Section", "c", 0) == 3);
+		CHECK(flat.get<int>("Section", "e", -1) == 0 && flat.get<int>("Section", "d", 0) == 3);
+
+		config.clear();
+		CHECK(!config.has_key("Section", "a") && config.get<int>("Section", "a", 7) == 7);
+	}
+}
+
+int main(){
+	directory = std::filesystem::temp_directory_path() / ("config_test" + std::to_string(std::random_device{}()));
+	std::filesystem::create_directories(directory);
+
+	test_handles();
+	test_case_insensitive_keys();
+	test_mapped_load();
+	test_typed_cache();
+	test_save_changes();
+	test_binary_cache();
+	test_layered();
+
+	std::filesystem::remove_all(directory);
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,147 @@
+/*
+*	Sweeps the approximations in fastMath.h against double precision references and checks the documented error bounds.
+*	Scalar and batched forms are both checked, the batched ones use the widest instruction set the CPU supports.
+*	Prints the largest error of every function and returns a non-zero exit code if any bound is exceeded.
+*/
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstddef>
+#include <algorithm>
+#include "fastMath.h"
+
+namespace{
+	using namespace util::math;
+
+	int failures = 0;
+
+	//Evenly spaced over [min, max] plus both ends, which are often the worst cases
+	std::vector<float> sweep(float min, float max, std::size_t count){
+		std::vector<float> values(count);
+
+		for(std::size_t i = 0; i < count; ++i)
+			values[i] = static_cast<float>(min + (static_cast<double>(max) - min) * static_cast<double>(i) / static_cast<double>(count - 1));
+
+		return values;
+	}
+
+	struct Error{
+		bool relative;
+		double max = 0.0;
+		float worstInput = 0.0f;
+
+		void add(float input, float result, double reference){
+			double error = std::abs(result - reference) / (relative ? std::abs(reference) : 1.0);
+
+			if(!(error <= max)){ //NaN counts as the worst error
+				max = error;
+				worstInput = input;
+			}
+		}
+	};
+
+	void report(const char* name, const Error& error, double bound){
+		bool passed = error.max <= bound;
+
+		std::printf("%-16s %s error %.3g (bound %.3g) at %.9g%s\n", name, error.relative ? "relative" : "absolute", error.max, bound,
+					static_cast<double>(error.worstInput), passed ? "" : "  FAILED");
+
+		if(!passed)
+			++failures;
+	}
+
+	template<typename Scalar, typename Batched, typename Reference>
+	void check(const char* name, const std::vector<float>& inputs, bool relative, double bound, Scalar scalar, Batched batched, Reference reference){
+		std::vector<float> results(inputs.size());
+		Error scalarError{relative}, batchedError{relative};
+
+		batched(inputs.data(), results.data(), inputs.size());
+
+		for(std::size_t i = 0; i < inputs.size(); ++i){
+			double expected = reference(static_cast<double>(inputs[i]));
+
+			scalarError.add(inputs[i], scalar(inputs[i]), expected);
+			batchedError.add(inputs[i], results[i], expected);
+		}
+
+		report(name, scalarError, bound);
+		report((std::string{name} + " batched").c_str(), batchedError, bound);
+	}
+}
+
+int main(){
+	constexpr std::size_t count = 1 << 21;
+
+#ifdef UTIL_SSE2
+	constexpr double rsqrtApproxBound = 3.7e-4, rsqrtBound = 5e-7;
+#else
+	constexpr double rsqrtApproxBound = 1.8e-3, rsqrtBound = 5e-6;
+#endif
+
+	std::vector<float> positive = sweep(std::numeric_limits<float>::min(), 1e6f, count);
+	std::vector<float> unit = sweep(0.5f, 2.0f, count); //Covers a full period of the mantissa
+
+	positive.insert(positive.end(), unit.begin(), unit.end());
+
+	auto rsqrtReference = [](double x){ return 1.0 / std::sqrt(x); };
+
+	check("rsqrt_approx", positive, true, rsqrtApproxBound, [](float x){ return fast::rsqrt_approx(x); },
+		  [](const float* in, float* out, std::size_t n){ fast::rsqrt_approx(in, out, n); }, rsqrtReference);
+	check("rsqrt", positive, true, rsqrtBound, [](float x){ return fast::rsqrt(x); },
+		  [](const float* in, float* out, std::size_t n){ fast::rsqrt(in, out, n); }, rsqrtReference);
+
+	std::vector<float> angles = sweep(-8192.0f, 8192.0f, count);
+	std::vector<float> smallAngles = sweep(-7.0f, 7.0f, count);
+
+	angles.insert(angles.end(), smallAngles.begin(), smallAngles.end());
+
+	check("sin", angles, false, 1e-7, [](float x){ return fast::sin(x); },
+		  [](const float* in, float* out, std::size_t n){ fast::sin(in, out, n); }, [](double x){ return std::sin(x); });
+	check("cos", angles, false, 1e-7, [](float x){ return fast::cos(x); },
+		  [](const float* in, float* out, std::size_t n){ fast::cos(in, out, n); }, [](double x){ return std::cos(x); });
+	check("exp", sweep(-86.5f, 88.72f, count), true, 1e-7, [](float x){ return fast::exp(x); },
+		  [](const float* in, float* out, std::size_t n){ fast::exp(in, out, n); }, [](double x){ return std::exp(x); });
+
+	//atan2 over points on circles of several radii, so every angle and both tiny and huge ratios are covered
+	{
+		std::vector<float> ys, xs;
+
+		for(float radius : {1e-30f, 1.0f, 1e30f}){
+			for(float angle : sweep(-3.14159265f, 3.14159265f, count / 4)){
+				ys.push_back(radius * std::sin(angle));
+				xs.push_back(radius * std::cos(angle));
+			}
+		}
+
+		for(float axis : {0.0f, 1.0f, -1.0f}){
+			ys.insert(ys.end(), {axis, 0.0f, 1.0f, -1.0f});
+			xs.insert(xs.end(), {1.0f, axis, axis, axis});
+		}
+
+		std::vector<float> results(ys.size());
+		Error scalarError{false}, batchedError{false};
+
+		fast::atan2(ys.data(), xs.data(), results.data(), ys.size());
+
+		for(std::size_t i = 0; i < ys.size(); ++i){
+			double expected = std::atan2(static_cast<double>(ys[i]), static_cast<double>(xs[i]));
+
+			scalarError.add(ys[i], fast::atan2(ys[i], xs[i]), expected);
+			batchedError.add(ys[i], results[i], expected);
+		}
+
+		report("atan2", scalarError, 3e-7);
+		report("atan2 batched", batchedError, 3e-7);
+	}
+
+	//Exact cases the documentation promises
+	if(fast::exp(100.0f) != std::numeric_limits<float>::infinity() || fast::exp(-100.0f) != 0.0f || fast::normalize(Vec3f{}).x != 0.0f){
+		std::printf("special cases FAILED\n");
+		++failures;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+/*
+*	Checks the generators in random.h against the reference implementations and the documented ranges.
+*	The jump states were computed independently by raising the xoshiro256 transition matrix to the power 2^128 and 2^192.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <unordered_set>
+#include "random.h"
+#include "mathUtil.h"
+
+namespace{
+	using namespace util::math;
+
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	template<typename Generator, typename T, std::size_t N>
+	bool produces(Generator gen, const T (&expected)[N]){
+		for(T value : expected){
+			if(gen() != value)
+				return false;
+		}
+
+		return true;
+	}
+
+	bool has_state(const Xoshiro256& gen, const std::uint64_t (&expected)[4]){
+		return std::equal(expected, expected + 4, gen.state());
+	}
+
+	void test_reference_vectors(){
+		constexpr std::uint64_t splitMix[] = {6457827717110365317u, 3203168211198807973u, 9817491932198370423u, 4593380528125082431u, 16408922859458223821u};
+		constexpr std::uint64_t xoshiro[] = {0x2800001, 0x3800067, 0xcc00003800067, 0xcc201994400b2, 0x8012a2019ac433cd, 0x8a69978acdee33ba};
+		constexpr std::uint32_t pcg[] = {0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e};
+		constexpr std::uint64_t state[] = {1, 2, 3, 4};
+		constexpr std::uint64_t jumped[] = {0x8c7a153956b5f3d1, 0x701f1a713401d85e, 0x6527f66a65469085, 0x8386b786c4408050};
+		constexpr std::uint64_t longJumped[] = {0x096a8eb71295a400, 0xdbf84991e50f4516, 0x534ee745810d2a0e, 0x31655ca1a2215bf1};
+
+		CHECK(produces(SplitMix64{1234567}, splitMix));
+		CHECK(produces(Xoshiro256{state}, xoshiro));
+		CHECK(produces(Pcg32{42, 54}, pcg)); //pcg32-demo with the seed 42 and the stream 54
+
+		Xoshiro256 gen{state};
+
+		gen.jump();
+		CHECK(has_state(gen, jumped));
+
+		gen = Xoshiro256{state};
+		gen.long_jump();
+		CHECK(has_state(gen, longJumped));
+
+		gen = Xoshiro256{state};
+		CHECK(has_state(gen.split(), state) && has_state(gen, jumped));
+
+		//Restoring a saved state continues the sequence
+		Xoshiro256 seeded{99};
+		Xoshiro256 restored{{seeded.state()[0], seeded.state()[1], seeded.state()[2], seeded.state()[3]}};
+
+		CHECK(seeded() == restored() && seeded() == restored());
+
+		//advance is the same as stepping
+		for(std::uint64_t steps : {0u, 1u, 2u, 1000u, 12345u}){
+			Pcg32 stepped{7, 3}, advanced{7, 3};
+
+			for(std::uint64_t i = 0; i < steps; ++i)
+				stepped();
+
+			advanced.advance(steps);
+			CHECK(stepped() == advanced());
+		}
+	}
+
+	//The lanes of Xoshiro256x4 are the scalar generator and the next three jumps, interleaved one output at a time
+	void test_bulk_matches_scalar(){
+		for(std::size_t count : {1u, 7u, 8u, 37u, 1000u}){
+			Xoshiro256x4 bulk{Xoshiro256{5}};
+			Xoshiro256 lanes[4] = {Xoshiro256{5}, Xoshiro256{5}, Xoshiro256{5}, Xoshiro256{5}};
+			std::vector<std::uint32_t> words(count);
+			bool same = true;
+
+			for(int lane = 1; lane < 4; ++lane){
+				for(int j = 0; j < lane; ++j)
+					lanes[lane].jump();
+			}
+
+			bulk.fill(words.data(), count);
+
+			for(std::size_t i = 0; i < count; i += 8){
+				for(int lane = 0; lane < 4; ++lane){
+					std::uint64_t value = lanes[lane]();
+
+					for(std::size_t half = 0; half < 2; ++half){
+						std::size_t index = i + static_cast<std::size_t>(lane) * 2 + half;
+
+						if(index < count)
+							same &= words[index] == static_cast<std::uint32_t>(value >> (half * 32));
+					}
+				}
+			}
+
+			CHECK(same);
+		}
+	}
+
+	//Outputs of the first steps of every stream, none of which may show up in another stream
+	void test_streams_dont_overlap(){
+		constexpr std::size_t steps = 1 << 16;
+		std::vector<Xoshiro256> streams;
+		Xoshiro256 base{11};
+
+		for(int i = 0; i < 4; ++i)
+			streams.push_back(base.split());
+
+		ThreadRng threadRng{base};
+		std::vector<std::uint32_t> words(steps);
+
+		streams.push_back(threadRng.single);
+
+		std::unordered_set<std::uint64_t> seen;
+		std::size_t total = 0;
+
+		for(Xoshiro256& stream : streams){
+			for(std::size_t i = 0; i < steps; ++i, ++total)
+				seen.insert(stream());
+		}
+
+		//The bulk lanes continue after the single generator of the thread
+		threadRng.bulk.fill(words.data(), steps);
+
+		for(std::size_t i = 0; i < steps; i += 2, ++total)
+			seen.insert(std::uint64_t{words[i]} | (std::uint64_t{words[i + 1]} << 32));
+
+		CHECK(seen.size() == total);
+
+		//Threads get different streams
+		std::vector<std::uint64_t> firstOutputs(8);
+		std::vector<std::thread> threads;
+
+		for(std::size_t i = 0; i < firstOutputs.size(); ++i)
+			threads.emplace_back([&, i]{ firstOutputs[i] = thread_rng()(); });
+
+		for(auto& thread : threads)
+			thread.join();
+
+		std::sort(firstOutputs.begin(), firstOutputs.end());
+		CHECK(std::adjacent_find(firstOutputs.begin(), firstOutputs.end()) == firstOutputs.end());
+
+		//Reseeding makes the thread's sequence reproducible
+		seed_thread_rng(42);
+
+		std::uint64_t first = thread_rng()();
+
+		seed_thread_rng(42);
+		CHECK(thread_rng()() == first);
+	}
+
+	void test_ranges(){
+		constexpr std::pair<float, float> floatRanges[] = {{0.0f, 1.0f}, {-5.0f, 5.0f}, {-1.0f, -0.5f}, {100.0f, 1000.0f}, {0.25f, 0.2500001f}, {-1.0f, 0.0f}};
+		constexpr std::pair<std::int32_t, std::int32_t> intRanges[] = {{0, 0}, {0, 1}, {-3, 3}, {0, 6}, {-2147483647 - 1, 2147483647}, {1000, 1000000}};
+		Xoshiro256 gen{3};
+		Xoshiro256x4 bulk{3};
+		std::vector<float> floats(1001);
+		std::vector<std::int32_t> ints(1001);
+
+		for(auto [min, max] : floatRanges){
+			bool inside = true;
+
+			for(int i = 0; i < 10000; ++i){
+				float a = rand_range(min, max);
+				float b = uniform_float(gen, min, max);
+
+				inside &= a >= min && a < max && b >= min && b < max;
+			}
+
+			bulk.fill(floats.data(), floats.size(), min, max);
+			inside &= std::all_of(floats.begin(), floats.end(), [&](float f){ return f >= min && f < max; });
+
+			CHECK(inside);
+			CHECK(bits_to_float(0, min, max) == min);
+			CHECK(bits_to_float(0xffffffff, min, max) < max);
+		}
+
+		for(auto [min, max] : intRanges){
+			bool inside = true;
+			bool hitMin = false, hitMax = false;
+
+			for(int i = 0; i < 10000; ++i){
+				std::int32_t value = uniform_int(gen, min, max);
+
+				inside &= value >= min && value <= max;
+				hitMin |= value == min;
+				hitMax |= value == max;
+			}
+
+			bulk.fill(ints.data(), ints.size(), min, max);
+			inside &= std::all_of(ints.begin(), ints.end(), [&](std::int32_t i){ return i >= min && i <= max; });
+
+			CHECK(inside);
+			CHECK((hitMin && hitMax) || max - static_cast<std::int64_t>(min) > 1000);
+		}
+	}
+}
+
+int main(){
+	test_reference_vectors();
+	test_bulk_matches_scalar();
+	test_streams_dont_overlap();
+	test_ranges();
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
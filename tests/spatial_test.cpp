@@ -0,0 +1,355 @@
+/*
+*	Compares the queries of Bvh and PointGrid against brute force scans over random and degenerate inputs.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include "spatial.h"
+
+namespace{
+	using namespace util::math;
+
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	constexpr float infinity = std::numeric_limits<float>::infinity();
+
+	std::mt19937 rng{7};
+
+	float random(float min, float max){ return std::uniform_real_distribution<float>{min, max}(rng); }
+	Vec3f random_point(float min, float max){ return {random(min, max), random(min, max), random(min, max)}; }
+
+	Vec3f random_direction(){
+		Vec3f d{random(-1.0f, 1.0f), random(-1.0f, 1.0f), random(-1.0f, 1.0f)};
+		float length = d.length();
+
+		return {d.x / length, d.y / length, d.z / length};
+	}
+
+	//Primitives are spheres, their boxes are what the tree is built from
+	struct Spheres{
+		std::vector<Vec3f> centers;
+		std::vector<float> radii;
+		std::vector<AABB> boxes;
+
+		void add(const Vec3f center, float radius){
+			centers.push_back(center);
+			radii.push_back(radius);
+			boxes.push_back({center - Vec3f{radius, radius, radius}, center + Vec3f{radius, radius, radius}});
+		}
+
+		float intersect(std::uint32_t primitive, const Ray& ray) const{
+			Vec3f offset = ray.origin - centers[primitive];
+			float b = offset.dot(ray.direction);
+			float h = b * b - (offset.dot(offset) - radii[primitive] * radii[primitive]);
+			float t = h >= 0.0f ? -b - std::sqrt(h) : -1.0f;
+
+			return t >= 0.0f ? t : infinity;
+		}
+	};
+
+	std::vector<std::uint32_t> sorted(std::vector<std::uint32_t> indices){
+		std::sort(indices.begin(), indices.end());
+
+		return indices;
+	}
+
+	std::vector<std::uint32_t> brute_force_query(const std::vector<AABB>& boxes, const AABB& box){
+		std::vector<std::uint32_t> found;
+
+		for(std::uint32_t i = 0; i < boxes.size(); ++i){
+			if(boxes[i].overlaps(box))
+				found.push_back(i);
+		}
+
+		return found;
+	}
+
+	RayHit brute_force_hit(const Spheres& spheres, const Ray& ray, float maxDistance){
+		RayHit hit;
+
+		hit.distance = maxDistance;
+
+		for(std::uint32_t i = 0; i < spheres.boxes.size(); ++i){
+			float distance = spheres.intersect(i, ray);
+
+			if(distance < hit.distance){
+				hit.distance = distance;
+				hit.primitive = i;
+			}
+		}
+
+		return hit;
+	}
+
+	//Equally distant primitives may be found in any order, so only the distance has to match
+	bool same_hit(const Spheres& spheres, const Ray& ray, const RayHit& hit, const RayHit& expected){
+		return hit.hit() == expected.hit() && hit.distance == expected.distance && (!hit.hit() || spheres.intersect(hit.primitive, ray) == hit.distance);
+	}
+
+	//Every primitive appears in exactly one leaf and every node contains its children or primitives
+	bool valid_tree(const Bvh& bvh, const std::vector<AABB>& boxes){
+		std::vector<int> seen(boxes.size(), 0);
+
+		for(std::uint32_t primitive : bvh.primitives())
+			++seen[primitive];
+
+		if(std::count(seen.begin(), seen.end(), 1) != static_cast<std::ptrdiff_t>(boxes.size()))
+			return false;
+
+		const auto& nodes = bvh.nodes();
+		auto contains = [](const AABB& outer, const AABB& inner){ return outer.contains(inner.min) && outer.contains(inner.max); };
+
+		for(const Bvh::Node& node : nodes){
+			if(node.leaf()){
+				for(std::uint32_t i = node.index; i < node.index + node.count; ++i){
+					if(!contains(node.bounds, boxes[bvh.primitives()[i]]))
+						return false;
+				}
+			}else if(node.index + 1 >= nodes.size() || !contains(node.bounds, nodes[node.index].bounds) || !contains(node.bounds, nodes[node.index + 1].bounds)){
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void check_queries(const Spheres& spheres, const BvhOptions& options){
+		Bvh bvh{spheres.boxes.data(), spheres.boxes.size(), options};
+
+		CHECK(valid_tree(bvh, spheres.boxes));
+
+		std::vector<AABB> boxes;
+
+		for(int i = 0; i < 100; ++i){
+			Vec3f min = random_point(-10.0f, 110.0f);
+
+			boxes.push_back({min, min + random_point(0.0f, 10.0f)});
+		}
+
+		IndexLists lists = bvh.query(boxes.data(), boxes.size(), 3);
+
+		CHECK(lists.size() == boxes.size());
+
+		for(std::size_t i = 0; i < boxes.size(); ++i){
+			std::vector<std::uint32_t> found;
+
+			bvh.query(boxes[i], [&](std::uint32_t primitive){ found.push_back(primitive); });
+
+			std::vector<std::uint32_t> expected = brute_force_query(spheres.boxes, boxes[i]);
+
+			CHECK(sorted(found) == expected);
+			CHECK(sorted({lists.begin(i), lists.end(i)}) == expected);
+		}
+
+		std::vector<Ray> rays;
+
+		for(int i = 0; i < 200; ++i)
+			rays.push_back({random_point(0.0f, 100.0f), random_direction()});
+
+		auto intersect = [&](std::uint32_t primitive, const Ray& ray, float){ return spheres.intersect(primitive, ray); };
+
+		for(float maxDistance : {5.0f, 1000.0f, infinity}){
+			std::vector<RayHit> hits(rays.size());
+
+			bvh.closest_hits(rays.data(), rays.size(), maxDistance, intersect, hits.data(), 3);
+
+			for(std::size_t i = 0; i < rays.size(); ++i){
+				RayHit expected = brute_force_hit(spheres, rays[i], maxDistance);
+
+				CHECK(same_hit(spheres, rays[i], bvh.closest_hit(rays[i], maxDistance, intersect), expected));
+				CHECK(same_hit(spheres, rays[i], hits[i], expected));
+			}
+		}
+	}
+
+	void test_bvh(){
+		Spheres spheres;
+
+		for(int i = 0; i < 5000; ++i)
+			spheres.add(random_point(0.0f, 100.0f), random(0.1f, 2.0f));
+
+		check_queries(spheres, {});
+		check_queries(spheres, {1, 1, 0});    //One primitive per leaf
+		check_queries(spheres, {4, 4, 64});   //Many subtrees built on other threads
+		check_queries(spheres, {16, 8, 256});
+
+		//Boxes the ray misses are skipped without a distance limit just like with a large one
+		Bvh bvh{spheres.boxes.data(), spheres.boxes.size()};
+		std::size_t intersections = 0;
+		auto count = [&](std::uint32_t, const Ray&, float){ ++intersections; return infinity; };
+
+		for(const Ray& ray : {Ray{{-10.0f, 50.0f, 50.0f}, {1.0f, 0.0f, 0.0f}}, Ray{{-50.0f, -50.0f, -50.0f}, {-1.0f, 0.0f, 0.0f}}}){
+			intersections = 0;
+			bvh.closest_hit(ray, 1e30f, count);
+
+			std::size_t limited = intersections;
+
+			intersections = 0;
+			bvh.closest_hit(ray, infinity, count);
+			CHECK(intersections == limited);
+			CHECK(intersections < 200);
+		}
+	}
+
+	void test_bvh_degenerate(){
+		Bvh empty{nullptr, 0};
+		int calls = 0;
+
+		empty.query(AABB{{-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}}, [&](std::uint32_t){ ++calls; });
+		CHECK(empty.empty() && calls == 0);
+		CHECK(!empty.closest_hit({{}, {1.0f, 0.0f, 0.0f}}, infinity, [](std::uint32_t, const Ray&, float){ return 0.0f; }).hit());
+
+		//Single primitive and fewer primitives than fit into a leaf
+		for(int count : {1, 3}){
+			Spheres spheres;
+
+			for(int i = 0; i < count; ++i)
+				spheres.add({static_cast<float>(i) * 3.0f, 0.0f, 0.0f}, 1.0f);
+
+			Bvh bvh{spheres.boxes.data(), spheres.boxes.size()};
+
+			CHECK(bvh.nodes().size() == 1 && bvh.nodes()[0].count == static_cast<std::uint32_t>(count));
+			check_queries(spheres, {});
+		}
+
+		//All centroids in one point end up in one leaf however many there are
+		Spheres same;
+
+		for(int i = 0; i < 1000; ++i)
+			same.add({50.0f, 50.0f, 50.0f}, static_cast<float>(i % 10) + 1.0f);
+
+		Bvh bvh{same.boxes.data(), same.boxes.size(), {2, 4, 16}};
+
+		CHECK(bvh.nodes().size() == 1);
+		check_queries(same, {2, 4, 16});
+
+		//Centroids on a line spread over the whole float range need median splits below the SAH depth limit
+		std::vector<AABB> line;
+
+		for(int i = 0; i < 3000; ++i){
+			float x = std::ldexp(1.0f, i % 250 - 125) * static_cast<float>(1 + i / 250);
+
+			line.push_back({{x, 0.0f, 0.0f}, {x, 0.0f, 0.0f}});
+		}
+
+		Bvh lineBvh{line.data(), line.size(), {1, 2, 100}};
+		std::size_t found = 0;
+
+		lineBvh.query(AABB{{0.0f, -1.0f, -1.0f}, {3e38f, 1.0f, 1.0f}}, [&](std::uint32_t){ ++found; });
+		CHECK(valid_tree(lineBvh, line));
+		CHECK(found == line.size());
+	}
+
+	std::vector<std::uint32_t> brute_force_radius(const std::vector<Vec3f>& points, const Vec3f center, float radius){
+		std::vector<std::uint32_t> found;
+
+		for(std::uint32_t i = 0; i < points.size(); ++i){
+			if((points[i] - center).length_sq() <= radius * radius)
+				found.push_back(i);
+		}
+
+		return found;
+	}
+
+	void test_grid(){
+		std::vector<Vec3f> points;
+
+		for(int i = 0; i < 20000; ++i)
+			points.push_back(random_point(0.0f, 100.0f));
+
+		for(float cellSize : {0.5f, 2.0f, 50.0f}){
+			PointGrid grid{points.data(), points.size(), cellSize};
+			std::vector<Vec3f> centers;
+
+			CHECK(grid.size() == points.size());
+
+			for(int i = 0; i < 100; ++i)
+				centers.push_back(random_point(-10.0f, 110.0f));
+
+			for(float radius : {0.0f, 1.0f, 2.0f, 7.5f}){
+				IndexLists lists = grid.find_in_radius(centers.data(), centers.size(), radius, 3);
+
+				for(std::size_t i = 0; i < centers.size(); ++i){
+					std::vector<std::uint32_t> found;
+
+					grid.for_each_in_radius(centers[i], radius, [&](std::uint32_t index){ found.push_back(index); });
+
+					std::vector<std::uint32_t> expected = brute_force_radius(points, centers[i], radius);
+
+					CHECK(sorted(found) == expected);
+					CHECK(sorted({lists.begin(i), lists.end(i)}) == expected);
+				}
+			}
+		}
+
+		//Radii covering more cells than there are points check every point, negative ones find nothing
+		PointGrid fine{points.data(), 1000, 0.001f};
+		std::vector<Vec3f> first(points.begin(), points.begin() + 1000);
+		std::vector<std::uint32_t> found;
+
+		fine.for_each_in_radius({50.0f, 50.0f, 50.0f}, 30.0f, [&](std::uint32_t index){ found.push_back(index); });
+		CHECK(sorted(found) == brute_force_radius(first, {50.0f, 50.0f, 50.0f}, 30.0f));
+
+		std::size_t count = 0;
+
+		fine.for_each_in_radius({50.0f, 50.0f, 50.0f}, 1e30f, [&](std::uint32_t){ ++count; });
+		CHECK(count == 1000);
+		count = 0;
+		fine.for_each_in_radius({50.0f, 50.0f, 50.0f}, -1.0f, [&](std::uint32_t){ ++count; });
+		CHECK(count == 0);
+
+		//Far apart points whose clamped cells would otherwise collide
+		Vec3f far[] = {{-1e12f, 0.0f, 0.0f}, {1e12f, 5.0f, 5.0f}};
+		PointGrid farGrid{far, 2, 1.0f};
+
+		count = 0;
+		farGrid.for_each_in_radius({1e12f, 5.0f, 5.0f}, 1.0f, [&](std::uint32_t index){ count += index == 1 ? 1 : 100; });
+		CHECK(count == 1);
+
+		PointGrid empty{nullptr, 0, 1.0f};
+
+		count = 0;
+		empty.for_each_in_radius({}, 10.0f, [&](std::uint32_t){ ++count; });
+		CHECK(count == 0);
+
+		//Cell sizes that aren't positive and finite are rejected
+		for(float cellSize : {0.0f, -1.0f, std::numeric_limits<float>::quiet_NaN(), infinity, std::numeric_limits<float>::denorm_min()}){
+			bool thrown = false;
+
+			try{
+				PointGrid grid{points.data(), 10, cellSize};
+			}catch(const std::invalid_argument&){
+				thrown = true;
+			}
+
+			CHECK(thrown);
+		}
+	}
+}
+
+int main(){
+	test_bvh();
+	test_bvh_degenerate();
+	test_grid();
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
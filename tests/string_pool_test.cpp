@@ -0,0 +1,146 @@
+/*
+*	Checks that StringPool hands out one dense id per distinct string and keeps the views stable.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <string>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <string_view>
+#include "stringPool.h"
+
+namespace{
+	using util::StringId;
+	using util::StringPool;
+	using util::CaseInsensitiveStringPool;
+
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	void test_dedup(){
+		StringPool pool;
+		StringId a = pool.intern("alpha");
+		StringId b = pool.intern("beta");
+
+		CHECK(a.value == 0 && b.value == 1 && pool.size() == 2);
+		CHECK(pool.intern(std::string{"alpha"}) == a && pool.intern("beta") == b && pool.size() == 2);
+		CHECK(pool.intern("Alpha") != a && pool.size() == 3);
+		CHECK(pool.find("beta") == b && !pool.find("gamma") && !StringId{});
+		CHECK(pool.view(a) == "alpha" && pool.view(b) == "beta");
+
+		//The empty string and embedded zeros are strings like any other
+		StringId empty = pool.intern("");
+		StringId zero = pool.intern(std::string_view{"a\0b", 3});
+
+		CHECK(empty.valid() && pool.intern({}) == empty && pool.view(empty).empty());
+		CHECK(zero != a && pool.view(zero) == std::string_view("a\0b", 3) && pool.find(std::string_view{"a\0c", 3}) != zero);
+
+		CaseInsensitiveStringPool caseless;
+		StringId first = caseless.intern("Content-Type");
+
+		CHECK(caseless.intern("content-type") == first && caseless.find("CONTENT-TYPE") == first && caseless.size() == 1);
+		CHECK(caseless.view(first) == "Content-Type" && caseless.intern("Content-Typ") != first);
+	}
+
+	//Ids past a block of views and strings past a chunk of the arena
+	void test_rollover(){
+		constexpr std::size_t count = 3 * 4096 + 17;
+
+		StringPool pool;
+		std::vector<std::string> strings;
+		std::vector<std::string_view> views;
+
+		//Long enough that the arena needs several chunks as well
+		for(std::size_t i = 0; i < count; ++i){
+			strings.push_back("string " + std::to_string(i) + std::string(i % 61, 'x'));
+			views.push_back(pool.view(pool.intern(strings.back())));
+		}
+
+		CHECK(pool.size() == count);
+
+		bool same = true;
+
+		for(std::size_t i = 0; i < count; ++i){
+			StringId id = pool.find(strings[i]);
+
+			same = same && id.value == i && pool.intern(strings[i]) == id && pool.view(id) == strings[i];
+			same = same && pool.view(id).data() == views[i].data(); //Views handed out earlier still point to the same memory
+		}
+
+		CHECK(same && pool.size() == count);
+
+		//Strings larger than a quarter chunk get memory of their own, larger than a whole chunk as well
+		std::string large(20 * 1024, 'l');
+		std::string huge(100 * 1024, 'h');
+
+		huge.back() = 'e';
+
+		StringId largeId = pool.intern(large);
+		StringId hugeId = pool.intern(huge);
+		StringId smallId = pool.intern("after");
+
+		CHECK(largeId.value == count && hugeId.value == count + 1 && smallId.value == count + 2);
+		CHECK(pool.view(largeId) == large && pool.view(hugeId) == huge && pool.view(smallId) == "after");
+		CHECK(pool.intern(std::string(huge)) == hugeId && pool.find(std::string(100 * 1024, 'h')) != hugeId);
+	}
+
+	//Threads interning the same strings agree on the ids and can look up each other's ids
+	void test_concurrent(){
+		constexpr std::size_t threadCount = 4;
+		constexpr std::size_t count = 4999; //Prime, so every stride below visits each string once
+
+		StringPool pool;
+		std::vector<std::vector<StringId>> ids(threadCount, std::vector<StringId>(count));
+		std::vector<std::thread> threads;
+
+		for(std::size_t t = 0; t < threadCount; ++t){
+			threads.emplace_back([&, t]{
+				//Each thread goes through the strings in a different order
+				for(std::size_t i = 0; i < count; ++i){
+					std::size_t n = (i * (2 * t + 1) + t * 977) % count;
+					std::string s = "s" + std::to_string(n);
+					StringId id = pool.intern(s);
+
+					ids[t][n] = id;
+
+					if(pool.view(id) != s)
+						ids[t][n] = StringId{};
+				}
+			});
+		}
+
+		for(std::thread& thread : threads)
+			thread.join();
+
+		bool agree = true;
+
+		for(std::size_t n = 0; n < count; ++n){
+			for(std::size_t t = 0; t < threadCount; ++t)
+				agree = agree && ids[t][n].valid() && ids[t][n] == ids[0][n];
+
+			agree = agree && pool.view(ids[0][n]) == "s" + std::to_string(n);
+		}
+
+		CHECK(agree && pool.size() == count);
+	}
+}
+
+int main(){
+	test_dedup();
+	test_rollover();
+	test_concurrent();
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
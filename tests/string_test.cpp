@@ -0,0 +1,392 @@
+/*
+*	Round trip checks for str::to_string and str::parse_value and for typed values stored in a Config.
+*	Also checks str::format and splitting against the implementations they replaced and CaseInsensitiveMap against std::map.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <map>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include "config.h"
+#include "stringUtil.h"
+#include "caseInsensitiveMap.h"
+
+namespace{
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	template<typename T>
+	bool round_trips(T value){
+		util::str::ParseResult<T> parsed = util::str::parse_value<T>(util::str::to_string(value));
+
+		return parsed && parsed.value == value;
+	}
+
+	template<typename T>
+	bool config_round_trips(T value){
+		util::Config config;
+
+		config.set("section", "key", value);
+
+		const util::Config& constConfig = config;
+
+		return config.get<T>("section", "key", T{}) == value && constConfig.get<T>("section", "key", T{}) == value;
+	}
+
+	//The strtoul based str::format from before placeholders were parsed at compile time
+	std::string reference_format(std::string_view fmt, const std::vector<std::string>& values){
+		std::string result;
+		std::string terminated{fmt};
+
+		for(std::size_t i = 0; i < terminated.size(); ++i){
+			if(terminated[i] == '{'){
+				char* end;
+				std::size_t index = std::strtoul(&terminated[i + 1], &end, 10);
+				std::size_t start = i;
+
+				while(&terminated[i] != end)
+					++i;
+
+				if(*end == '}' && index > 0 && index <= values.size())
+					result += values[index - 1];
+				else
+					result += std::string_view{&terminated[start], i - start + (*end ? 1 : 0)};
+			}else{
+				result.push_back(terminated[i]);
+			}
+		}
+
+		return result;
+	}
+
+	void test_format(){
+		using util::str::format;
+
+		CHECK(format("{1} + {1} = {2}", 1, 2) == "1 + 1 = 2");
+		CHECK(format("{2}{1}", 'a', "b") == "ba");
+		CHECK(format("{1}", -1.5f) == "-1.5" && format("{1}", true) == "1" && format("{1}", std::string{"s"}) == "s");
+		CHECK(format("{10}", 1, 2, 3, 4, 5, 6, 7, 8, 9, "ten") == "ten");
+
+		//Doubled braces are never placeholders
+		CHECK(format("{{1}}", 5) == "{{1}}" && format("{{1}", 5) == "{{1}" && format("{{{1}}}", 5) == "{{5}}");
+		CHECK(format("{}{{}}", 5) == "{}{{}}" && format("{12{1}", 5) == "{12{1}");
+
+		//Placeholders without a matching argument are written as they are, unused arguments are ignored
+		CHECK(format("{0} {2} {3}", 1, 2) == "{0} 2 {3}");
+		CHECK(format("{1}") == "{1}" && format("", 1) == "" && format("no placeholders", 1, 2) == "no placeholders");
+		CHECK(format("{-1} {1 } {x} {1", 1) == "{-1} {1 } {x} {1" && format("{", 1) == "{" && format("}", 1) == "}");
+		CHECK(format("{18446744073709551617}", 1) == "{18446744073709551617}");
+
+		constexpr util::str::FormatString fmt{"{{1} {2}/{3} {1}"};
+
+		CHECK(format(fmt, 'x', 2) == "{{1} 2/{3} x");
+
+		char buffer[4];
+
+		CHECK(util::str::format_to_n(buffer, sizeof(buffer), "{1}{2}", "abc", "def") == 6 && std::string_view(buffer, 4) == "abcd");
+
+		//Random format strings made of braces, digits and text agree with the old implementation
+		std::mt19937 rng{5};
+		const std::vector<std::string> values = {"one", "", "three"};
+		constexpr std::string_view alphabet = "{{}}0123x";
+		bool same = true;
+
+		for(int i = 0; i < 20000; ++i){
+			std::string fmt;
+
+			for(std::size_t length = rng() % 12; length > 0; --length)
+				fmt += alphabet[rng() % alphabet.size()];
+
+			same &= format(fmt, values[0], values[1], values[2]) == reference_format(fmt, values);
+		}
+
+		CHECK(same);
+	}
+
+	template<typename Range>
+	bool splits_into(const Range& range, std::initializer_list<std::string_view> expected){
+		return std::equal(range.begin(), range.end(), expected.begin(), expected.end());
+	}
+
+	//Every field between delimiters, including empty ones
+	std::vector<std::string> reference_split_keep_empty(const std::string& s, char delimiter){
+		std::vector<std::string> result(1);
+
+		for(char c : s){
+			if(c == delimiter)
+				result.emplace_back();
+			else
+				result.back() += c;
+		}
+
+		return result;
+	}
+
+	void test_split(){
+		using util::str::split_range;
+
+		CHECK(splits_into(split_range("a,b,,c", ','), {"a", "b", "c"}));
+		CHECK(splits_into(split_range("a,b,,c", ',', true), {"a", "b", "", "c"}));
+		CHECK(splits_into(split_range(",a,", ','), {"a"}) && splits_into(split_range(",a,", ',', true), {"", "a", ""}));
+		CHECK(splits_into(split_range(",,", ','), {}) && splits_into(split_range(",,", ',', true), {"", "", ""}));
+		CHECK(splits_into(split_range("", ','), {}) && splits_into(split_range("", ',', true), {""}));
+		CHECK(splits_into(split_range("abc", ','), {"abc"}) && splits_into(split_range("abc", ',', true), {"abc"}));
+
+		CHECK(splits_into(split_range("  one\ttwo \n three  "), {"one", "two", "three"}));
+		CHECK(splits_into(split_range(""), {}) && splits_into(split_range(" \t\r\n\v\f"), {}) && splits_into(split_range("x"), {"x"}));
+
+		//Post increment and iterators of an empty range
+		auto range = split_range("a b");
+		auto it = range.begin();
+
+		CHECK(*it++ == "a" && *it == "b" && ++it == range.end() && split_range("").begin() == split_range("").end());
+
+		//Random strings long enough for the vectorized search, compared with the stream based split and split_at that were replaced
+		std::mt19937 rng{9};
+		constexpr std::string_view alphabet = "ab, \t\n,,";
+		bool same = true;
+
+		for(int i = 0; i < 5000; ++i){
+			std::string s;
+
+			for(std::size_t length = rng() % 100; length > 0; --length)
+				s += alphabet[rng() % alphabet.size()];
+
+			std::istringstream words{s}, fields{s};
+			std::vector<std::string> splitWords, splitFields;
+			std::string token;
+
+			while(words >> token)
+				splitWords.push_back(token);
+
+			while(std::getline(fields, token, ',')){
+				if(!token.empty())
+					splitFields.push_back(token);
+			}
+
+			same &= util::str::split(s) == splitWords && util::str::split_at(s, ',') == splitFields;
+
+			std::vector<std::string> kept;
+
+			for(std::string_view field : split_range(s, ',', true))
+				kept.emplace_back(field);
+
+			same &= kept == reference_split_keep_empty(s, ',');
+		}
+
+		CHECK(same);
+	}
+
+	bool same_contents(const util::CaseInsensitiveMap<int>& map, const std::map<std::string, std::pair<std::string, int>>& reference){
+		if(map.size() != reference.size())
+			return false;
+
+		for(const auto& [key, value] : map){
+			auto it = reference.find(util::str::to_lower(key));
+
+			if(it == reference.end() || it->second.first != key || it->second.second != value)
+				return false;
+		}
+
+		for(const auto& [lowerKey, entry] : reference){
+			auto it = map.find(util::str::to_upper(lowerKey));
+
+			if(it == map.end() || it->second != entry.second)
+				return false;
+		}
+
+		return true;
+	}
+
+	void test_case_insensitive_map(){
+		util::CaseInsensitiveMap<int> map{{"One", 1}, {"TWO", 2}};
+
+		CHECK(map.size() == 2 && map.at("one") == 1 && map.at("two") == 2 && map.contains("oNe") && !map.contains("three"));
+		CHECK(!map.try_emplace("ONE", 5).second && map.find("one")->first == "One" && map.at("one") == 1); //The first spelling stays
+
+		map.insert_or_assign("one", 10);
+		map["Three"] = 3;
+		CHECK(map.at("ONE") == 10 && map["three"] == 3 && map.size() == 3);
+
+		bool threw = false;
+
+		try{
+			map.at("four");
+		}catch(const std::out_of_range&){
+			threw = true;
+		}
+
+		CHECK(threw);
+		CHECK(map.erase("TWO") && !map.erase("two") && !map.contains("two") && map.size() == 2);
+
+		map.clear();
+		CHECK(map.empty() && !map.contains("one") && !map.erase("one") && map.find("one") == map.end());
+		CHECK(!util::CaseInsensitiveMap<int>{}.erase("x") && !util::CaseInsensitiveMap<int>{}.contains(""));
+
+		//Random inserts and erases over few distinct keys keep long probe sequences around, which the backward shift has to repair
+		std::mt19937 rng{3};
+		util::CaseInsensitiveMap<int> randomMap;
+		std::map<std::string, std::pair<std::string, int>> reference;
+		bool same = true;
+
+		for(int i = 0; i < 30000; ++i){
+			std::string key = "key" + std::to_string(rng() % 300);
+
+			for(char& c : key)
+				c = rng() % 2 ? util::str::to_upper_ascii(c) : c;
+
+			std::string lowerKey = util::str::to_lower(key);
+			int value = static_cast<int>(rng() % 1000);
+
+			switch(rng() % 5){
+				case 0:
+				case 1:{
+					bool inserted = randomMap.try_emplace(key, value).second;
+
+					same &= inserted == reference.emplace(lowerKey, std::pair{key, value}).second;
+
+					break;
+				}
+				case 2:
+					randomMap.insert_or_assign(key, value);
+					reference.try_emplace(lowerKey, key, value).first->second.second = value;
+
+					break;
+				default:
+					same &= randomMap.erase(key) == (reference.erase(lowerKey) == 1);
+			}
+
+			if(i % 1000 == 0){
+				same &= same_contents(randomMap, reference);
+
+				if(i % 7000 == 0)
+					randomMap.reserve(randomMap.size() * 4); //Rehashing in between
+			}
+		}
+
+		CHECK(same && same_contents(randomMap, reference));
+
+		//Erasing everything leaves a map that works like a new one
+		for(const auto& [lowerKey, entry] : reference)
+			same &= randomMap.erase(entry.first);
+
+		CHECK(same && randomMap.empty());
+
+		randomMap["again"] = 1;
+		CHECK(randomMap.size() == 1 && randomMap.at("AGAIN") == 1);
+	}
+}
+
+int main(){
+	using namespace util;
+
+	//char is written and read as the character itself
+	for(char c : {'x', '0', '7', ' ', '\t', ';', '='})
+		CHECK(round_trips(c));
+
+	CHECK(str::to_string('x') == "x");
+	CHECK(!str::parse_value<char>("xy"));
+	CHECK(!str::parse_value<char>(""));
+	CHECK(str::parse_value<char>(" x ").value == 'x');
+	CHECK(config_round_trips('x'));
+	CHECK(config_round_trips('5'));
+
+	//signed and unsigned char stay numbers
+	CHECK(str::to_string(static_cast<signed char>(65)) == "65");
+	CHECK(round_trips(static_cast<signed char>(-128)));
+	CHECK(round_trips(static_cast<unsigned char>(255)));
+
+	CHECK(round_trips(true));
+	CHECK(round_trips(false));
+	CHECK(round_trips(std::numeric_limits<int>::min()));
+	CHECK(round_trips(std::numeric_limits<std::uint64_t>::max()));
+	CHECK(round_trips(0.1));
+	CHECK(round_trips(1.0f / 3.0f));
+	CHECK(round_trips(std::numeric_limits<double>::max()));
+	CHECK(round_trips(std::numeric_limits<double>::denorm_min()));
+	CHECK(round_trips(std::chrono::milliseconds{250}));
+	CHECK(round_trips(std::chrono::minutes{-3}));
+	CHECK(config_round_trips(42));
+	CHECK(config_round_trips(-0.5));
+	CHECK(config_round_trips(std::string{"text with spaces"}));
+
+	//bool only accepts true, false, 1 and 0
+	CHECK(str::parse_value<bool>("TRUE").value && str::parse_value<bool>(" 1 ").value);
+	CHECK(str::parse_value<bool>("False") && !str::parse_value<bool>("False").value && !str::parse_value<bool>("0").value);
+	CHECK(str::parse_value<bool>("yes").error == std::errc::invalid_argument);
+	CHECK(str::parse_value<bool>("2").error == std::errc::invalid_argument);
+	CHECK(str::parse_value<bool>("").error == std::errc::invalid_argument);
+	CHECK(config_round_trips(true) && Config{}.get<bool>("section", "key", true));
+
+	//Floating point values use the shortest form and reject what std::strtod accepts but std::from_chars doesn't
+	CHECK(str::to_string(0.1) == "0.1" && str::to_string(-2.5f) == "-2.5" && str::to_string(1e300) == "1e+300");
+	CHECK(str::parse_value<double>("+1.5").value == 1.5 && str::parse_value<double>("-.5").value == -0.5);
+	CHECK(!str::parse_value<double>("++1") && !str::parse_value<double>("+-1"));
+	CHECK(!str::parse_value<double>("0x10") && !str::parse_value<double>("1.5x") && !str::parse_value<double>("."));
+	CHECK(str::parse_value<double>("1e400").error == std::errc::result_out_of_range);
+	CHECK(str::parse_value<float>("1e39").error == std::errc::result_out_of_range);
+	CHECK(std::isinf(str::parse_value<double>("-inf").value) && std::isnan(str::parse_value<double>("nan").value));
+	CHECK(str::format("{1}", 1.0 / 3.0) == "0.333333");
+
+	test_format();
+	test_split();
+	test_case_insensitive_map();
+
+	//Durations with every unit, without one, rounded to the target period and out of range
+	{
+		using namespace std::chrono;
+		using Minutes = duration<double, std::ratio<60>>;
+
+		CHECK(str::parse_value<nanoseconds>("3ns").value == nanoseconds{3});
+		CHECK(str::parse_value<nanoseconds>("7us").value == microseconds{7});
+		CHECK(str::parse_value<microseconds>("250ms").value == milliseconds{250});
+		CHECK(str::parse_value<milliseconds>("1.5s").value == milliseconds{1500});
+		CHECK(str::parse_value<seconds>("2min").value == minutes{2} && str::parse_value<seconds>("2m").value == minutes{2});
+		CHECK(str::parse_value<minutes>("3h").value == hours{3});
+		CHECK(str::parse_value<hours>("2d").value == hours{48});
+		CHECK(str::parse_value<milliseconds>(" -20ms ").value == milliseconds{-20});
+		CHECK(str::parse_value<milliseconds>("20").value == milliseconds{20} && str::parse_value<minutes>("2").value == minutes{2});
+		CHECK(str::parse_value<Minutes>("90s").value == Minutes{1.5});
+
+		CHECK(str::parse_value<seconds>("1.5ms").value == seconds{0});
+		CHECK(str::parse_value<seconds>("600ms").value == seconds{1});
+		CHECK(str::parse_value<seconds>("-1.5s").value == seconds{-2});
+
+		CHECK(str::parse_value<seconds>("5 s").error == std::errc::invalid_argument);
+		CHECK(str::parse_value<seconds>("5sec").error == std::errc::invalid_argument);
+		CHECK(str::parse_value<seconds>("ms").error == std::errc::invalid_argument);
+		CHECK(str::parse_value<seconds>("").error == std::errc::invalid_argument);
+		CHECK(str::parse_value<seconds>("nan").error == std::errc::invalid_argument);
+		CHECK(str::parse_value<seconds>("infs").error == std::errc::invalid_argument);
+		CHECK(str::parse_value<Minutes>("-infms").error == std::errc::invalid_argument);
+
+		CHECK(str::parse_value<duration<std::int32_t>>("2147483647s").value.count() == 2147483647);
+		CHECK(str::parse_value<duration<std::int32_t>>("2147483648s").error == std::errc::result_out_of_range);
+		CHECK(str::parse_value<nanoseconds>("1000000d").error == std::errc::result_out_of_range);
+		CHECK(str::parse_value<hours>("1e300d").error == std::errc::result_out_of_range);
+		CHECK(str::parse_value<Minutes>("1e308d").error == std::errc::result_out_of_range);
+	}
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+/*
+*	Checks TimestampFormatter against std::strftime of util::local_time, from one thread and from many.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <ctime>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include "misc.h"
+
+namespace{
+	using util::TimestampFormatter;
+	using TimePoint = std::chrono::system_clock::time_point;
+
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	TimePoint at(std::int64_t nanoseconds){
+		return TimePoint{std::chrono::duration_cast<TimePoint::duration>(std::chrono::nanoseconds{nanoseconds})};
+	}
+
+	//What the formatter should produce, written the slow way
+	std::string reference(TimePoint time, const char* fmt, int fractionDigits){
+		std::int64_t nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+		std::int64_t second = nanoseconds / 1000000000;
+
+		if(nanoseconds % 1000000000 < 0)
+			--second;
+
+		char buffer[128];
+		std::tm timeInfo = util::local_time(static_cast<std::time_t>(second));
+		std::string result{buffer, std::strftime(buffer, sizeof(buffer), fmt, &timeInfo)};
+
+		if(fractionDigits > 0){
+			std::string fraction = std::to_string(nanoseconds - second * 1000000000);
+
+			fraction.insert(0, 9 - fraction.size(), '0');
+			result += '.' + fraction.substr(0, static_cast<std::size_t>(fractionDigits));
+		}
+
+		return result;
+	}
+
+	std::string format(const TimestampFormatter& formatter, TimePoint time){
+		char buffer[128];
+
+		return {buffer, formatter.format(time, buffer, sizeof(buffer))};
+	}
+
+	//The last second of a day in UTC, so the following seconds also change the minute, hour and day
+	constexpr std::int64_t base = 1700006399LL * 1000000000; //2023-11-14 23:59:59 UTC
+
+	//Several calls within one second take the cached prefix and only differ in the fraction
+	void test_cached_second(){
+		TimestampFormatter formatter;
+		bool same = true;
+
+		for(std::int64_t ns : {0LL, 1LL, 999999LL, 1000000LL, 123456789LL, 999999999LL})
+			same = same && format(formatter, at(base + ns)) == reference(at(base + ns), "%Y-%m-%d %H:%M:%S", 3);
+
+		CHECK(same);
+		CHECK(format(formatter, at(base + 5000000)).size() == 23);
+
+		for(int digits : {0, 1, 6, 9}){
+			TimestampFormatter precise{"%H:%M:%S", digits};
+
+			CHECK(format(precise, at(base + 987654321)) == reference(at(base + 987654321), "%H:%M:%S", digits));
+		}
+
+		//Out of range digit counts are clamped
+		CHECK(format(TimestampFormatter{"%S", -1}, at(base + 5)) == reference(at(base), "%S", 0));
+		CHECK(format(TimestampFormatter{"%S", 12}, at(base + 5)) == reference(at(base + 5), "%S", 9));
+	}
+
+	//Moving to another second, forwards or backwards, replaces the cached prefix
+	void test_rollover(){
+		TimestampFormatter formatter{"%Y-%m-%d %H:%M:%S %a", 6};
+		bool same = true;
+
+		for(std::int64_t ns : {0LL, 999999999LL, 1000000000LL, 1000000001LL, 0LL, 61000000000LL, 3601500000000LL, 86400000000001LL, 999999999LL, -1LL})
+			same = same && format(formatter, at(base + ns)) == reference(at(base + ns), "%Y-%m-%d %H:%M:%S %a", 6);
+
+		CHECK(same);
+
+		//Before the epoch the fraction still counts up from the start of the second
+		for(std::int64_t ns : {-1LL, -999999999LL, -1000000000LL, -1500000000LL})
+			CHECK(format(formatter, at(ns)) == reference(at(ns), "%Y-%m-%d %H:%M:%S %a", 6));
+
+		//A buffer that is too small gets the start of the timestamp and the full length is returned
+		char buffer[8];
+		std::string full = reference(at(base), "%Y-%m-%d %H:%M:%S %a", 6);
+
+		CHECK(formatter.format(at(base), buffer, sizeof(buffer)) == full.size() && full.compare(0, sizeof(buffer), buffer, sizeof(buffer)) == 0);
+	}
+
+	//Threads racing over a few seconds, so the cache is replaced while others read it
+	void test_concurrent(){
+		constexpr std::size_t threadCount = 4;
+		constexpr std::size_t count = 20000;
+
+		TimestampFormatter formatter{"%d.%m.%Y %H:%M:%S", 9};
+		std::vector<std::string> expected;
+
+		for(std::int64_t s = 0; s < 5; ++s)
+			expected.push_back(reference(at(base + s * 1000000000 + s * 7), "%d.%m.%Y %H:%M:%S", 9));
+
+		std::atomic<std::size_t> mismatches = 0;
+		std::vector<std::thread> threads;
+
+		for(std::size_t t = 0; t < threadCount; ++t){
+			threads.emplace_back([&, t]{
+				for(std::size_t i = 0; i < count; ++i){
+					std::size_t s = (i / (t + 1) + t) % expected.size();
+					auto ns = static_cast<std::int64_t>(s);
+
+					if(format(formatter, at(base + ns * 1000000000 + ns * 7)) != expected[s])
+						mismatches.fetch_add(1, std::memory_order_relaxed);
+				}
+			});
+		}
+
+		for(std::thread& thread : threads)
+			thread.join();
+
+		CHECK(mismatches == 0);
+	}
+
+	void test_now(){
+		TimestampFormatter formatter;
+		auto before = std::chrono::system_clock::now();
+		auto now = formatter.now();
+		auto after = std::chrono::system_clock::now();
+
+		CHECK(now >= before - std::chrono::milliseconds{100} && now <= after + std::chrono::milliseconds{100});
+		CHECK(formatter.str().size() == 23);
+	}
+}
+
+int main(){
+	test_cached_second();
+	test_rollover();
+	test_concurrent();
+	test_now();
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
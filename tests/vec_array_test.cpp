@@ -0,0 +1,269 @@
+/*
+*	Checks Vec3fArray storage and compares the batched operations with the scalar Vec3f and Mat4f ones.
+*	Sizes around the SIMD widths make sure the scalar tails are covered for every instruction set.
+*	Returns a non-zero exit code and prints every failed check.
+*/
+
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <iostream>
+#include <algorithm>
+#include "vecArray.h"
+#include "random.h"
+
+namespace{
+	using util::math::Mat4f;
+	using util::math::Vec3f;
+	using util::math::Vec3fArray;
+	using util::math::Xoshiro256;
+	using util::math::uniform_float;
+	namespace batch = util::math::batch;
+
+	int failures = 0;
+
+	void check(bool condition, const char* expression, int line){
+		if(!condition){
+			std::cerr << "line " << line << ": " << expression << '\n';
+			++failures;
+		}
+	}
+
+#define CHECK(...) check((__VA_ARGS__), #__VA_ARGS__, __LINE__)
+
+	//Up to two full AVX2 registers plus every possible tail
+	constexpr std::size_t sizes[] = {0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 100};
+
+	std::vector<Vec3f> random_vectors(Xoshiro256& rng, std::size_t count){
+		std::vector<Vec3f> values(count);
+
+		for(Vec3f& v : values)
+			v = {uniform_float(rng, -10.0f, 10.0f), uniform_float(rng, -10.0f, 10.0f), uniform_float(rng, -10.0f, 10.0f)};
+
+		return values;
+	}
+
+	//Kernels may add in a different order than the scalar code, scale is the magnitude of the terms
+	bool close(float result, float expected, float scale = 1.0f){
+		return std::abs(result - expected) <= 1e-5f * std::max(scale, std::abs(expected));
+	}
+
+	bool close(Vec3f result, Vec3f expected, float scale = 1.0f){
+		return close(result.x, expected.x, scale) && close(result.y, expected.y, scale) && close(result.z, expected.z, scale);
+	}
+
+	bool same(Vec3f v1, Vec3f v2){
+		return v1.x == v2.x && v1.y == v2.y && v1.z == v2.z;
+	}
+
+	bool holds(const Vec3fArray& array, const std::vector<Vec3f>& values){
+		if(array.size() != values.size())
+			return false;
+
+		for(std::size_t i = 0; i < values.size(); ++i){
+			if(!same(array[i], values[i]))
+				return false;
+		}
+
+		return true;
+	}
+
+	bool aligned(const float* lane){
+		return reinterpret_cast<std::uintptr_t>(lane) % Vec3fArray::alignment == 0;
+	}
+
+	void test_storage(){
+		Xoshiro256 rng{1};
+		std::vector<Vec3f> values = random_vectors(rng, 37);
+		Vec3fArray array{values.data(), values.size()};
+
+		CHECK(holds(array, values) && array.capacity() >= values.size());
+		CHECK(aligned(array.x()) && aligned(array.y()) && aligned(array.z()));
+
+		//Growing keeps the elements, resizing fills with zeros
+		for(int i = 0; i < 50; ++i){
+			values.push_back({static_cast<float>(i), 1.0f, 2.0f});
+			array.push_back(values.back());
+		}
+
+		CHECK(holds(array, values) && aligned(array.y()) && aligned(array.z()));
+
+		array.resize(values.size() + 3);
+		values.resize(values.size() + 3, Vec3f{0.0f, 0.0f, 0.0f});
+
+		CHECK(holds(array, values));
+
+		std::vector<Vec3f> out(array.size());
+
+		array.copy_to(out.data());
+		CHECK(std::equal(out.begin(), out.end(), values.begin(), values.end(), same));
+
+		Vec3fArray copy{array};
+
+		CHECK(holds(copy, values) && copy.x() != array.x());
+
+		Vec3fArray& self = copy;
+
+		copy = self;
+		CHECK(holds(copy, values));
+	}
+
+	//The moved from array is empty and can be used again
+	void test_move(){
+		std::vector<Vec3f> values{{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}, {7.0f, 8.0f, 9.0f}};
+		Vec3fArray array{values.data(), values.size()};
+		const float* x = array.x();
+		Vec3fArray moved{std::move(array)};
+
+		CHECK(holds(moved, values) && moved.x() == x);
+		CHECK(array.empty() && array.size() == 0 && array.capacity() == 0 && array.x() == nullptr);
+
+		Vec3fArray assigned{5};
+
+		assigned = std::move(moved);
+		CHECK(holds(assigned, values) && assigned.x() == x);
+		CHECK(moved.empty() && moved.capacity() == 0 && moved.x() == nullptr);
+
+		moved.push_back(values[1]);
+		array.resize(2);
+		CHECK(holds(moved, {values[1]}) && holds(array, {Vec3f{}, Vec3f{}}));
+
+		Vec3fArray& self = assigned;
+
+		assigned = std::move(self); //Self move assignment leaves the array unchanged
+		CHECK(holds(assigned, values));
+	}
+
+	//Every size compared element by element with the scalar operations
+	void test_batch(){
+		Xoshiro256 rng{2};
+		Mat4f m = Mat4f::translation({1.5f, -2.0f, 0.25f}) * Mat4f::scaling({2.0f, -0.5f, 3.0f});
+
+		m.columns[0].y = 0.75f;
+		m.columns[2].x = -1.25f;
+
+		for(std::size_t n : sizes){
+			std::vector<Vec3f> va = random_vectors(rng, n), vb = random_vectors(rng, n), vc = random_vectors(rng, n);
+
+			//A few zero vectors for normalize
+			for(std::size_t i = 0; i < n; i += 7)
+				va[i] = {0.0f, 0.0f, 0.0f};
+
+			Vec3fArray a{va.data(), n}, b{vb.data(), n}, c{vc.data(), n}, out{3};
+			std::vector<float> scalars(n);
+			bool sum = true, difference = true, product = true, fma = true, lerp = true, clamp = true;
+			bool dot = true, length = true, normalize = true, cross = true, points = true, directions = true;
+
+			batch::add(a, b, out);
+			sum = out.size() == n;
+
+			for(std::size_t i = 0; i < n; ++i)
+				sum = sum && same(out[i], va[i] + vb[i]);
+
+			batch::sub(a, b, out);
+
+			for(std::size_t i = 0; i < n; ++i)
+				difference = difference && same(out[i], va[i] - vb[i]);
+
+			batch::mul(a, b, out);
+
+			for(std::size_t i = 0; i < n; ++i)
+				product = product && same(out[i], va[i] * vb[i]);
+
+			batch::fma(a, b, c, out);
+
+			for(std::size_t i = 0; i < n; ++i)
+				fma = fma && close(out[i], va[i] * vb[i] + vc[i], 100.0f);
+
+			batch::lerp(a, b, 0.3f, out);
+
+			for(std::size_t i = 0; i < n; ++i)
+				lerp = lerp && close(out[i], util::math::lerp(va[i], vb[i], Vec3f{0.3f, 0.3f, 0.3f}), 10.0f);
+
+			batch::clamp(a, -2.0f, 5.0f, out);
+
+			for(std::size_t i = 0; i < n; ++i){
+				Vec3f v = va[i];
+
+				clamp = clamp && same(out[i], {util::math::clamp(v.x, -2.0f, 5.0f), util::math::clamp(v.y, -2.0f, 5.0f), util::math::clamp(v.z, -2.0f, 5.0f)});
+			}
+
+			batch::dot(a, b, scalars.data());
+
+			for(std::size_t i = 0; i < n; ++i)
+				dot = dot && close(scalars[i], va[i].dot(vb[i]), 300.0f);
+
+			batch::length(a, scalars.data());
+
+			for(std::size_t i = 0; i < n; ++i)
+				length = length && close(scalars[i], va[i].length());
+
+			batch::normalize(a, out);
+
+			for(std::size_t i = 0; i < n; ++i){
+				float l = va[i].length();
+				Vec3f expected = l == 0.0f ? va[i] : Vec3f{va[i].x / l, va[i].y / l, va[i].z / l};
+
+				normalize = normalize && close(out[i], expected);
+			}
+
+			batch::cross(a, b, out);
+
+			for(std::size_t i = 0; i < n; ++i)
+				cross = cross && close(out[i], va[i].cross(vb[i]), 200.0f);
+
+			batch::transform_points(m, a, out);
+
+			for(std::size_t i = 0; i < n; ++i)
+				points = points && close(out[i], m.transform_point(va[i]), 100.0f);
+
+			batch::transform_directions(m, a, out);
+
+			for(std::size_t i = 0; i < n; ++i)
+				directions = directions && close(out[i], m.transform_direction(va[i]), 100.0f);
+
+			CHECK(sum && difference && product && fma && lerp && clamp);
+			CHECK(dot && length && normalize && cross && points && directions);
+
+			if(failures > 0){
+				std::cerr << "size " << n << '\n';
+				return;
+			}
+		}
+	}
+
+	//Outputs may be the same arrays as the inputs
+	void test_batch_in_place(){
+		Xoshiro256 rng{3};
+
+		for(std::size_t n : sizes){
+			std::vector<Vec3f> va = random_vectors(rng, n), vb = random_vectors(rng, n);
+			Vec3fArray a{va.data(), n}, b{vb.data(), n};
+			bool sum = true, cross = true;
+
+			batch::add(a, b, a);
+
+			for(std::size_t i = 0; i < n; ++i)
+				sum = sum && same(a[i], va[i] + vb[i]);
+
+			batch::cross(a, b, b);
+
+			for(std::size_t i = 0; i < n; ++i)
+				cross = cross && close(b[i], (va[i] + vb[i]).cross(vb[i]), 400.0f);
+
+			CHECK(sum && cross);
+		}
+	}
+}
+
+int main(){
+	test_storage();
+	test_move();
+	test_batch();
+	test_batch_in_place();
+
+	if(failures == 0)
+		std::cout << "All checks passed\n";
+
+	return failures == 0 ? 0 : 1;
+}
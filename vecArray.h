@@ -0,0 +1,276 @@
+#pragma once
+
+#include <new>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include "mathUtil.h"
+#include "simdLanes.h"
+
+namespace util::math{
+	//Pointers to the x, y and z lanes of a structure of arrays
+	template<typename T>
+	struct Vec3fLanes{
+		T* x;
+		T* y;
+		T* z;
+	};
+
+	/*
+	*	Array of Vec3f stored as three separate arrays of x, y and z components.
+	*	Every lane starts at a 32 byte boundary so that whole SIMD registers of the same component can be loaded at once.
+	*	Use the batched functions below to process many vectors at a time.
+	*/
+	class Vec3fArray{
+	public:
+		static constexpr std::size_t alignment = 32;
+
+		Vec3fArray() = default;
+
+		explicit Vec3fArray(std::size_t size){
+			resize(size);
+		}
+
+		Vec3fArray(const Vec3f* values, std::size_t count){
+			resize(count);
+
+			for(std::size_t i = 0; i < count; ++i)
+				set(i, values[i]);
+		}
+
+		Vec3fArray(const Vec3fArray& other){
+			*this = other;
+		}
+
+		//The moved from array is left empty
+		Vec3fArray(Vec3fArray&& other) noexcept :
+			storage{std::move(other.storage)}, arraySize{std::exchange(other.arraySize, 0)}, arrayCapacity{std::exchange(other.arrayCapacity, 0)}{}
+
+		Vec3fArray& operator=(const Vec3fArray& other){
+			if(this != &other){
+				resize(other.arraySize);
+				copy_lanes(other.lanes(), lanes(), arraySize);
+			}
+
+			return *this;
+		}
+
+		Vec3fArray& operator=(Vec3fArray&& other) noexcept{
+			if(this != &other){
+				storage = std::move(other.storage);
+				arraySize = std::exchange(other.arraySize, 0);
+				arrayCapacity = std::exchange(other.arrayCapacity, 0);
+			}
+
+			return *this;
+		}
+
+		std::size_t size() const noexcept{ return arraySize; }
+		std::size_t capacity() const noexcept{ return arrayCapacity; }
+		bool empty() const noexcept{ return arraySize == 0; }
+
+		float* x() noexcept{ return storage.get(); }
+		float* y() noexcept{ return storage.get() + arrayCapacity; }
+		float* z() noexcept{ return storage.get() + arrayCapacity * 2; }
+		const float* x() const noexcept{ return storage.get(); }
+		const float* y() const noexcept{ return storage.get() + arrayCapacity; }
+		const float* z() const noexcept{ return storage.get() + arrayCapacity * 2; }
+
+		Vec3fLanes<float> lanes() noexcept{ return {x(), y(), z()}; }
+		Vec3fLanes<const float> lanes() const noexcept{ return {x(), y(), z()}; }
+
+		Vec3f operator[](std::size_t index) const noexcept{ return {x()[index], y()[index], z()[index]}; }
+
+		void set(std::size_t index, const Vec3f value) noexcept{
+			x()[index] = value.x;
+			y()[index] = value.y;
+			z()[index] = value.z;
+		}
+
+		void push_back(const Vec3f value){
+			if(arraySize == arrayCapacity)
+				reserve(std::max<std::size_t>(arrayCapacity * 2, 16));
+
+			set(arraySize++, value);
+		}
+
+		void reserve(std::size_t count){
+			if(count <= arrayCapacity)
+				return;
+
+			std::size_t newCapacity = (count + 7) & ~std::size_t{7}; //Keeps every lane aligned
+			Storage newStorage{static_cast<float*>(::operator new(newCapacity * 3 * sizeof(float), std::align_val_t{alignment}))};
+
+			if(storage)
+				copy_lanes(std::as_const(*this).lanes(), {newStorage.get(), newStorage.get() + newCapacity, newStorage.get() + newCapacity * 2}, arraySize);
+
+			storage = std::move(newStorage);
+			arrayCapacity = newCapacity;
+		}
+
+		//New elements are zero
+		void resize(std::size_t count){
+			reserve(count);
+
+			if(count > arraySize){
+				std::fill(x() + arraySize, x() + count, 0.0f);
+				std::fill(y() + arraySize, y() + count, 0.0f);
+				std::fill(z() + arraySize, z() + count, 0.0f);
+			}
+
+			arraySize = count;
+		}
+
+		void clear() noexcept{ arraySize = 0; }
+
+		//Writes all elements back as an array of structures
+		void copy_to(Vec3f* out) const noexcept{
+			for(std::size_t i = 0; i < arraySize; ++i)
+				out[i] = (*this)[i];
+		}
+
+	private:
+		struct AlignedDelete{
+			void operator()(float* data) const noexcept{ ::operator delete(data, std::align_val_t{alignment}); }
+		};
+
+		using Storage = std::unique_ptr<float[], AlignedDelete>;
+
+		Storage storage;
+		std::size_t arraySize = 0;
+		std::size_t arrayCapacity = 0;
+
+		static void copy_lanes(Vec3fLanes<const float> from, Vec3fLanes<float> to, std::size_t count) noexcept{
+			if(count > 0){
+				std::memcpy(to.x, from.x, count * sizeof(float));
+				std::memcpy(to.y, from.y, count * sizeof(float));
+				std::memcpy(to.z, from.z, count * sizeof(float));
+			}
+		}
+	};
+
+	namespace batch{
+#define UTIL_KERNEL_TARGET
+		namespace baseline{
+#ifdef UTIL_SSE2
+			using Lane = simd::Sse2Lane;
+#else
+			using Lane = simd::ScalarLane;
+#endif
+
+#include "vecArray.inl"
+		}
+#undef UTIL_KERNEL_TARGET
+
+#ifdef UTIL_AVX2_DISPATCH
+#define UTIL_KERNEL_TARGET UTIL_TARGET_AVX2
+		namespace avx2{
+			using Lane = simd::Avx2Lane;
+
+#include "vecArray.inl"
+		}
+#undef UTIL_KERNEL_TARGET
+#endif
+
+		//Calls func with the kernels for the best instruction set the CPU supports
+		template<typename Func>
+		void dispatch(Func&& func){
+#ifdef UTIL_AVX2_DISPATCH
+			if(simd::has_avx2())
+				return func(avx2::Kernels{}, avx2::Lane{});
+#endif
+			func(baseline::Kernels{}, baseline::Lane{});
+		}
+
+		/*
+		*	Batched operations on float spans and Vec3fArrays.
+		*	They have their own namespace so that they don't hide ::fma, math::lerp and the like inside util::math.
+		*	Outputs may be the same as inputs, Vec3fArray outputs are resized to the size of the first input.
+		*	All inputs must have the same size.
+		*/
+
+#define UTIL_BATCH(kernel, ...) dispatch([&](auto kernels, auto lane){ \
+			using Lane = decltype(lane); \
+			kernels.template kernel<simd::ScalarLane>(kernels.template kernel<Lane>(0, __VA_ARGS__), __VA_ARGS__); \
+		})
+
+		inline void add(const float* a, const float* b, float* out, std::size_t n) noexcept{ UTIL_BATCH(add, a, b, out, n); }
+		inline void sub(const float* a, const float* b, float* out, std::size_t n) noexcept{ UTIL_BATCH(sub, a, b, out, n); }
+		inline void mul(const float* a, const float* b, float* out, std::size_t n) noexcept{ UTIL_BATCH(mul, a, b, out, n); }
+
+		//out = a * b + c
+		inline void fma(const float* a, const float* b, const float* c, float* out, std::size_t n) noexcept{ UTIL_BATCH(fma, a, b, c, out, n); }
+
+		inline void lerp(const float* a, const float* b, float t, float* out, std::size_t n) noexcept{ UTIL_BATCH(lerp, a, b, t, out, n); }
+		inline void clamp(const float* values, float min, float max, float* out, std::size_t n) noexcept{ UTIL_BATCH(clamp, values, min, max, out, n); }
+
+		//Component wise operations apply the span version to each lane
+		template<typename Func>
+		void for_each_lane(Vec3fArray& out, std::size_t size, Func func){
+			out.resize(size);
+			func(0);
+			func(1);
+			func(2);
+		}
+
+		inline const float* lane(const Vec3fArray& a, int index) noexcept{ return index == 0 ? a.x() : index == 1 ? a.y() : a.z(); }
+		inline float* lane(Vec3fArray& a, int index) noexcept{ return index == 0 ? a.x() : index == 1 ? a.y() : a.z(); }
+
+		inline void add(const Vec3fArray& a, const Vec3fArray& b, Vec3fArray& out){
+			for_each_lane(out, a.size(), [&](int i){ add(lane(a, i), lane(b, i), lane(out, i), a.size()); });
+		}
+
+		inline void sub(const Vec3fArray& a, const Vec3fArray& b, Vec3fArray& out){
+			for_each_lane(out, a.size(), [&](int i){ sub(lane(a, i), lane(b, i), lane(out, i), a.size()); });
+		}
+
+		inline void mul(const Vec3fArray& a, const Vec3fArray& b, Vec3fArray& out){
+			for_each_lane(out, a.size(), [&](int i){ mul(lane(a, i), lane(b, i), lane(out, i), a.size()); });
+		}
+
+		inline void fma(const Vec3fArray& a, const Vec3fArray& b, const Vec3fArray& c, Vec3fArray& out){
+			for_each_lane(out, a.size(), [&](int i){ fma(lane(a, i), lane(b, i), lane(c, i), lane(out, i), a.size()); });
+		}
+
+		inline void lerp(const Vec3fArray& a, const Vec3fArray& b, float t, Vec3fArray& out){
+			for_each_lane(out, a.size(), [&](int i){ lerp(lane(a, i), lane(b, i), t, lane(out, i), a.size()); });
+		}
+
+		inline void clamp(const Vec3fArray& a, float min, float max, Vec3fArray& out){
+			for_each_lane(out, a.size(), [&](int i){ clamp(lane(a, i), min, max, lane(out, i), a.size()); });
+		}
+
+		//out needs room for a.size() elements
+		inline void dot(const Vec3fArray& a, const Vec3fArray& b, float* out) noexcept{ UTIL_BATCH(dot, a.lanes(), b.lanes(), out, a.size()); }
+		inline void length(const Vec3fArray& a, float* out) noexcept{ UTIL_BATCH(length, a.lanes(), out, a.size()); }
+
+		//Zero vectors stay zero
+		inline void normalize(const Vec3fArray& a, Vec3fArray& out){
+			out.resize(a.size());
+			UTIL_BATCH(normalize, a.lanes(), out.lanes(), a.size());
+		}
+
+		inline void cross(const Vec3fArray& a, const Vec3fArray& b, Vec3fArray& out){
+			out.resize(a.size());
+			UTIL_BATCH(cross, a.lanes(), b.lanes(), out.lanes(), a.size());
+		}
+
+		//Same as Mat4f::transform_point for every element
+		inline void transform_points(const Mat4f& m, const Vec3fArray& a, Vec3fArray& out){
+			out.resize(a.size());
+			UTIL_BATCH(transform, m, 1.0f, a.lanes(), out.lanes(), a.size());
+		}
+
+		//Same as Mat4f::transform_direction for every element
+		inline void transform_directions(const Mat4f& m, const Vec3fArray& a, Vec3fArray& out){
+			out.resize(a.size());
+			UTIL_BATCH(transform, m, 0.0f, a.lanes(), out.lanes(), a.size());
+		}
+
+#undef UTIL_BATCH
+	}
+}
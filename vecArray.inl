@@ -0,0 +1,138 @@
+//Batched kernels shared by all instruction sets, included once per lane type with Lane and UTIL_KERNEL_TARGET defined
+
+/*
+*	Every kernel processes as many elements as possible with Lane and the rest with ScalarLane.
+*	The templated part returns the index it stopped at so the same code handles both.
+*/
+struct Kernels{
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t add(std::size_t i, const float* a, const float* b, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width)
+			L::store(out + i, L::add(L::load(a + i), L::load(b + i)));
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t sub(std::size_t i, const float* a, const float* b, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width)
+			L::store(out + i, L::sub(L::load(a + i), L::load(b + i)));
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t mul(std::size_t i, const float* a, const float* b, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width)
+			L::store(out + i, L::mul(L::load(a + i), L::load(b + i)));
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t fma(std::size_t i, const float* a, const float* b, const float* c, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width)
+			L::store(out + i, L::add(L::mul(L::load(a + i), L::load(b + i)), L::load(c + i)));
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t lerp(std::size_t i, const float* a, const float* b, float t, float* out, std::size_t n) noexcept{
+		auto factor = L::set(t);
+
+		for(; i + L::width <= n; i += L::width){
+			auto start = L::load(a + i);
+
+			L::store(out + i, L::add(start, L::mul(L::sub(L::load(b + i), start), factor)));
+		}
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t clamp(std::size_t i, const float* values, float min, float max, float* out, std::size_t n) noexcept{
+		auto low = L::set(min);
+		auto high = L::set(max);
+
+		for(; i + L::width <= n; i += L::width)
+			L::store(out + i, L::min(L::max(L::load(values + i), low), high));
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t dot(std::size_t i, Vec3fLanes<const float> a, Vec3fLanes<const float> b, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width){
+			auto x = L::mul(L::load(a.x + i), L::load(b.x + i));
+			auto y = L::mul(L::load(a.y + i), L::load(b.y + i));
+			auto z = L::mul(L::load(a.z + i), L::load(b.z + i));
+
+			L::store(out + i, L::add(L::add(x, y), z));
+		}
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t length(std::size_t i, Vec3fLanes<const float> a, float* out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width){
+			auto x = L::load(a.x + i), y = L::load(a.y + i), z = L::load(a.z + i);
+
+			L::store(out + i, L::sqrt(L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z))));
+		}
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t normalize(std::size_t i, Vec3fLanes<const float> a, Vec3fLanes<float> out, std::size_t n) noexcept{
+		auto smallest = L::set(std::numeric_limits<float>::min()); //Zero vectors stay zero instead of becoming NaN
+		auto one = L::set(1.0f);
+
+		for(; i + L::width <= n; i += L::width){
+			auto x = L::load(a.x + i), y = L::load(a.y + i), z = L::load(a.z + i);
+			auto lengthSq = L::add(L::add(L::mul(x, x), L::mul(y, y)), L::mul(z, z));
+			auto scale = L::div(one, L::sqrt(L::max(lengthSq, smallest)));
+
+			L::store(out.x + i, L::mul(x, scale));
+			L::store(out.y + i, L::mul(y, scale));
+			L::store(out.z + i, L::mul(z, scale));
+		}
+
+		return i;
+	}
+
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t cross(std::size_t i, Vec3fLanes<const float> a, Vec3fLanes<const float> b, Vec3fLanes<float> out, std::size_t n) noexcept{
+		for(; i + L::width <= n; i += L::width){
+			auto ax = L::load(a.x + i), ay = L::load(a.y + i), az = L::load(a.z + i);
+			auto bx = L::load(b.x + i), by = L::load(b.y + i), bz = L::load(b.z + i);
+
+			L::store(out.x + i, L::sub(L::mul(ay, bz), L::mul(az, by)));
+			L::store(out.y + i, L::sub(L::mul(az, bx), L::mul(ax, bz)));
+			L::store(out.z + i, L::sub(L::mul(ax, by), L::mul(ay, bx)));
+		}
+
+		return i;
+	}
+
+	//w is 1 for points and 0 for directions
+	template<typename L>
+	UTIL_KERNEL_TARGET static std::size_t transform(std::size_t i, const Mat4f& m, float w, Vec3fLanes<const float> a, Vec3fLanes<float> out, std::size_t n) noexcept{
+		const Vec4f* c = m.columns;
+		auto m00 = L::set(c[0].x), m01 = L::set(c[1].x), m02 = L::set(c[2].x), m03 = L::set(c[3].x * w);
+		auto m10 = L::set(c[0].y), m11 = L::set(c[1].y), m12 = L::set(c[2].y), m13 = L::set(c[3].y * w);
+		auto m20 = L::set(c[0].z), m21 = L::set(c[1].z), m22 = L::set(c[2].z), m23 = L::set(c[3].z * w);
+
+		for(; i + L::width <= n; i += L::width){
+			auto x = L::load(a.x + i), y = L::load(a.y + i), z = L::load(a.z + i);
+
+			L::store(out.x + i, L::add(L::add(L::mul(m00, x), L::mul(m01, y)), L::add(L::mul(m02, z), m03)));
+			L::store(out.y + i, L::add(L::add(L::mul(m10, x), L::mul(m11, y)), L::add(L::mul(m12, z), m13)));
+			L::store(out.z + i, L::add(L::add(L::mul(m20, x), L::mul(m21, y)), L::add(L::mul(m22, z), m23)));
+		}
+
+		return i;
+	}
+};